@@ -0,0 +1,42 @@
+// Heap allocations of a benchmark, counted through the replaceable global operator new and delete (the benchmarks run
+// the simulation on a single thread). Include it in the benchmark source only, the operators are defined once per
+// program.
+
+#ifndef ALLOCATION_COUNTER_H
+#define ALLOCATION_COUNTER_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+static uint64_t allocations = 0;
+
+static void* CountedAllocation(std::size_t size) {
+        allocations++;
+        if (void* ptr = std::malloc(size)) return ptr;
+        throw std::bad_alloc();
+}
+
+// aligned_alloc needs a size multiple of the alignment
+static void* CountedAlignedAllocation(std::size_t size, std::align_val_t alignment) {
+        allocations++;
+        std::size_t align = static_cast<std::size_t>(alignment);
+        if (void* ptr = std::aligned_alloc(align, (size + align - 1) / align * align)) return ptr;
+        throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size) { return CountedAllocation(size); }
+void* operator new[](std::size_t size) { return CountedAllocation(size); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return CountedAlignedAllocation(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return CountedAlignedAllocation(size, alignment); }
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+
+#endif
@@ -0,0 +1,274 @@
+// Headless simulation benchmark.
+//
+// Builds the mountain with the regular EntityManager/EntityFactory/EntityDataManager and runs
+// EntityManager::Update back to back (no window, no texture, no pacing) using a scripted input
+// sequence. Reports ticks per second, p50/p99 tick time, sprites published per tick, objects resident per tick (the
+// mountain is loaded band by band around the camera), heap allocations
+// per tick, broadphase queries and candidate pairs per tick and peak RSS. The cost of a query is measured by replaying the
+// boxes queried during the run against the final state of the mountain. The loading time of the entity types is shown
+// apart, with whether it came from the binary cache (warm start) or from the text file (cold start, cache rebuilt).
+//
+// Usage: ./icesim [ticks] [seed] [tree|bvh|sapx|sapy|all]
+//
+// "all" replays the same scenario on every broadphase backend and prints one line per backend.
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <optional>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <defines.h>
+#include <entity_data_manager.h>
+#include <entity_manager.h>
+#include <broadphase.h>
+#include <bench/allocation_counter.h>
+
+const uint32_t MAX_OBJECTS = 1000;
+const uint32_t DEFAULT_TICKS = 10000;
+const size_t QUERY_LOG_CAPACITY = 1 << 16; // Queried boxes kept for the replay
+const int QUERY_REPLAY_PASSES = 5;
+
+struct ScriptedInput { uint32_t ticks; uint8_t keys; };
+
+// Input loop replayed during the whole run: walk, jump, hit and run in both directions.
+const ScriptedInput inputScript[] = {
+        { 30, IC_KEY_NONE },
+        { 60, IC_KEY_RIGHT },
+        { 20, IC_KEY_NONE },
+        { 4,  IC_KEY_UP },
+        { 60, IC_KEY_NONE },
+        { 4,  IC_KEY_SPACE },
+        { 20, IC_KEY_NONE },
+        { 60, IC_KEY_LEFT },
+        { 30, IC_KEY_LEFT | IC_KEY_UP },
+        { 60, IC_KEY_NONE },
+        { 40, IC_KEY_RIGHT },
+        { 30, IC_KEY_RIGHT | IC_KEY_UP },
+        { 60, IC_KEY_NONE },
+};
+
+static uint8_t scriptedKeys(uint64_t tick) {
+        uint64_t loopLength = 0;
+        for (auto const& input : inputScript) loopLength += input.ticks;
+
+        uint64_t t = tick % loopLength;
+        for (auto const& input : inputScript) {
+                if (t < input.ticks) return input.keys;
+                t -= input.ticks;
+        }
+
+        return IC_KEY_NONE;
+}
+
+// Queues the key edges between the previous and the current scripted key state, as the render thread would do.
+static void pushKeyEvents(InputQueue *inputQueue, uint8_t previousKeys, uint8_t keys) {
+        for (uint8_t key = IC_KEY_SPACE; key != 0; key <<= 1) {
+                if ((keys & key) != (previousKeys & key)) inputQueue->push(key, (keys & key) != 0);
+        }
+}
+
+// The simulation logs heavily to stdout; point stdout to /dev/null while it runs.
+static int muteStdout() {
+        fflush(stdout);
+        std::cout.flush();
+        int savedFd = dup(STDOUT_FILENO);
+        int nullFd = open("/dev/null", O_WRONLY);
+        dup2(nullFd, STDOUT_FILENO);
+        close(nullFd);
+        return savedFd;
+}
+
+static void restoreStdout(int savedFd) {
+        fflush(stdout);
+        std::cout.flush();
+        dup2(savedFd, STDOUT_FILENO);
+        close(savedFd);
+}
+
+static long peakRssKilobytes() {
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+        return usage.ru_maxrss / 1024; // Bytes on macOS
+#else
+        return usage.ru_maxrss;        // Kilobytes on Linux
+#endif
+}
+
+struct ScenarioResult {
+        double startupMs;
+        double assetsMs;         // EntityDataManager construction, included in the startup
+        bool assetsFromCache;
+        double ticksPerSecond;
+        double p50, p99;
+        double spritesPerTick;
+        double objectsPerTick;
+        double allocationsPerTick;
+        double queriesPerTick;
+        double pairsPerTick;     // Candidates gathered by the broadphase pass of the tick
+        double fallbacksPerTick; // Narrowphase checks not covered by the pairs of the tick
+        double nanosecondsPerQuery;
+};
+
+// Returns nothing when the mountain cannot be loaded.
+static std::optional<ScenarioResult> runScenario(BroadphaseType broadphaseType, uint64_t ticks, unsigned seed) {
+        ScenarioResult result = {};
+        srand(seed);
+
+        std::vector<double> tickTimes;
+        tickTimes.reserve(ticks);
+        std::vector<BroadphaseQuery> queryLog;
+        queryLog.reserve(QUERY_LOG_CAPACITY);
+
+        int savedStdout = muteStdout();
+
+        auto s0 = std::chrono::steady_clock::now();
+        EntityDataManager *entityDataManager = new EntityDataManager();
+        auto a1 = std::chrono::steady_clock::now();
+        SpriteRectTripleBuffer *spriteRectTripleBuffer = new SpriteRectTripleBuffer(MAX_OBJECTS);
+        InputQueue *inputQueue = new InputQueue();
+        EntityManager *entityManager = new EntityManager(entityDataManager, spriteRectTripleBuffer, inputQueue, MAX_OBJECTS, broadphaseType);
+        auto s1 = std::chrono::steady_clock::now();
+
+        if (!entityManager->IsLoaded()) {
+                restoreStdout(savedStdout);
+                delete entityManager;
+                delete spriteRectTripleBuffer;
+                delete inputQueue;
+                delete entityDataManager;
+                return std::nullopt;
+        }
+
+        Broadphase *broadphase = entityManager->GetBroadphase();
+        uint64_t queriesBefore = broadphase->QueryCount();
+        broadphase->LogQueries(&queryLog);
+
+        uint8_t keys = IC_KEY_NONE;
+        uint64_t publishedSprites = 0;
+        uint64_t residentObjects = 0;
+        uint64_t pairs = 0;
+        uint64_t tickAllocations = 0;
+        auto t0 = std::chrono::steady_clock::now();
+        for (uint64_t tick = 0; tick < ticks; tick++) {
+                uint8_t previousKeys = keys;
+                keys = scriptedKeys(tick);
+                auto tickStart = std::chrono::steady_clock::now();
+                pushKeyEvents(inputQueue, previousKeys, keys);
+                uint64_t allocationsBefore = allocations;
+                entityManager->Update();
+                tickAllocations += allocations - allocationsBefore;
+                auto tickEnd = std::chrono::steady_clock::now();
+                tickTimes.push_back(std::chrono::duration<double, std::micro>(tickEnd - tickStart).count());
+                publishedSprites += spriteRectTripleBuffer->consumerFrame().length;
+                residentObjects += entityManager->GetObjectCount();
+                pairs += entityManager->GetBroadphasePairs()->PairCount();
+        }
+        auto t1 = std::chrono::steady_clock::now();
+
+        broadphase->LogQueries(nullptr);
+        uint64_t queries = broadphase->QueryCount() - queriesBefore;
+
+        restoreStdout(savedStdout);
+
+        // Replay the logged queries (best pass)
+        std::vector<aabb::AABBIntersection<IEntity*>> intersections;
+        intersections.reserve(64);
+        double bestReplayNs = 0.0;
+        for (int pass = 0; pass < QUERY_REPLAY_PASSES && !queryLog.empty(); pass++) {
+                auto r0 = std::chrono::steady_clock::now();
+                for (auto const& query : queryLog) {
+                        intersections.clear();
+                        broadphase->Query(query.bounds, intersections, query.mask);
+                }
+                auto r1 = std::chrono::steady_clock::now();
+                double replayNs = std::chrono::duration<double, std::nano>(r1 - r0).count();
+                if (pass == 0 || replayNs < bestReplayNs) bestReplayNs = replayNs;
+        }
+
+        double totalSeconds = std::chrono::duration<double>(t1 - t0).count();
+        if (!tickTimes.empty()) {
+                std::sort(tickTimes.begin(), tickTimes.end());
+                result.p50 = tickTimes[(tickTimes.size() - 1) * 50 / 100];
+                result.p99 = tickTimes[(tickTimes.size() - 1) * 99 / 100];
+        }
+        result.startupMs = std::chrono::duration<double, std::milli>(s1 - s0).count();
+        result.assetsMs = std::chrono::duration<double, std::milli>(a1 - s0).count();
+        result.assetsFromCache = entityDataManager->LoadedFromCache();
+        result.ticksPerSecond = totalSeconds > 0.0 ? ticks / totalSeconds : 0.0;
+        result.spritesPerTick = ticks > 0 ? static_cast<double>(publishedSprites) / ticks : 0.0;
+        result.objectsPerTick = ticks > 0 ? static_cast<double>(residentObjects) / ticks : 0.0;
+        result.allocationsPerTick = ticks > 0 ? static_cast<double>(tickAllocations) / ticks : 0.0;
+        result.queriesPerTick = ticks > 0 ? static_cast<double>(queries) / ticks : 0.0;
+        result.pairsPerTick = ticks > 0 ? static_cast<double>(pairs) / ticks : 0.0;
+        result.fallbacksPerTick = ticks > 0 ? static_cast<double>(entityManager->GetBroadphasePairs()->FallbackCount()) / ticks : 0.0;
+        result.nanosecondsPerQuery = queryLog.empty() ? 0.0 : bestReplayNs / queryLog.size();
+
+        delete entityManager;
+        delete spriteRectTripleBuffer;
+        delete inputQueue;
+        delete entityDataManager;
+
+        return result;
+}
+
+int main(int argc, char** argv)
+{
+        uint64_t ticks = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : DEFAULT_TICKS;
+        unsigned seed = (argc > 2) ? static_cast<unsigned>(std::strtoul(argv[2], nullptr, 10)) : 1u;
+        std::string backend = (argc > 3) ? argv[3] : BroadphaseName(BROADPHASE_BVH);
+
+        if (backend == "all") {
+                printf("ticks: %llu  seed: %u\n", static_cast<unsigned long long>(ticks), seed);
+                printf("%-8s %12s %12s %10s %10s %13s %10s %12s\n", "backend", "startup ms", "ticks/sec", "p50 us", "p99 us", "queries/tick", "ns/query", "allocs/tick");
+                for (uint8_t type = 0; type < BROADPHASE_TYPES; type++) {
+                        std::optional<ScenarioResult> scenario = runScenario(static_cast<BroadphaseType>(type), ticks, seed);
+                        if (!scenario.has_value()) {
+                                fprintf(stderr, "Unable to load the mountain %s\n", MOUNTAIN_FILENAME);
+                                return 1;
+                        }
+                        const ScenarioResult& result = *scenario;
+                        printf("%-8s %12.3f %12.1f %10.3f %10.3f %13.2f %10.1f %12.1f\n", BroadphaseName(static_cast<BroadphaseType>(type)),
+                               result.startupMs, result.ticksPerSecond, result.p50, result.p99, result.queriesPerTick,
+                               result.nanosecondsPerQuery, result.allocationsPerTick);
+                }
+                return 0;
+        }
+
+        std::optional<BroadphaseType> broadphaseType = BroadphaseTypeFromName(backend);
+        if (!broadphaseType.has_value()) {
+                fprintf(stderr, "Unknown broadphase: %s\n", backend.c_str());
+                return 1;
+        }
+
+        std::optional<ScenarioResult> scenario = runScenario(*broadphaseType, ticks, seed);
+        if (!scenario.has_value()) {
+                fprintf(stderr, "Unable to load the mountain %s\n", MOUNTAIN_FILENAME);
+                return 1;
+        }
+        const ScenarioResult& result = *scenario;
+
+        printf("ticks:       %llu\n", static_cast<unsigned long long>(ticks));
+        printf("seed:        %u\n", seed);
+        printf("broadphase:  %s\n", backend.c_str());
+        printf("startup:     %.3f ms\n", result.startupMs);
+        printf("assets:      %.3f ms (%s)\n", result.assetsMs, result.assetsFromCache ? "cache" : "text, cache rebuilt");
+        printf("ticks/sec:   %.1f\n", result.ticksPerSecond);
+        printf("tick p50:    %.3f us\n", result.p50);
+        printf("tick p99:    %.3f us\n", result.p99);
+        printf("sprites/tick: %.1f\n", result.spritesPerTick);
+        printf("objects/tick: %.1f\n", result.objectsPerTick);
+        printf("allocs/tick: %.1f\n", result.allocationsPerTick);
+        printf("queries/tick: %.2f\n", result.queriesPerTick);
+        printf("query:       %.1f ns\n", result.nanosecondsPerQuery);
+        printf("pairs/tick:  %.2f\n", result.pairsPerTick);
+        printf("fallbacks/tick: %.3f\n", result.fallbacksPerTick);
+        printf("peak RSS:    %ld KB\n", peakRssKilobytes());
+
+        return 0;
+}
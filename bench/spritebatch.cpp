@@ -0,0 +1,89 @@
+// Sprite submission benchmark.
+//
+// Draws N random sprites of the texture atlas per frame, first with one DrawTextureRec call per sprite and then
+// with SpriteBatch, and reports the average frame time of each method for 1k, 10k and 50k sprites.
+//
+// Meant to run headless on Mesa's software rasterizer, e.g.:
+//   LIBGL_ALWAYS_SOFTWARE=1 GALLIUM_DRIVER=llvmpipe xvfb-run -s "-screen 0 1280x720x24" ./spritebench [frames]
+
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <raylib/raylib.h>
+#include <defines.h>
+#include <filesystem.h>
+#include <sprite_batch.h>
+
+const uint32_t SPRITE_COUNTS[] = { 1000, 10000, 50000 };
+const uint32_t MAX_SPRITES = 50000;
+const uint32_t DEFAULT_FRAMES = 300;
+const int SCR_WIDTH = 1280;
+const int SCR_HEIGHT = 720;
+const float SPRITE_SIZE = 16.0f;
+
+static void fillFrame(SpriteRectFrame& frame, uint32_t count, Texture2D texture) {
+        for (uint32_t i = 0; i < count; i++) {
+                Rectangle source = { static_cast<float>(rand() % (texture.width / CELL_WIDTH) * CELL_WIDTH),
+                                     static_cast<float>(rand() % (texture.height / CELL_HEIGHT) * CELL_HEIGHT),
+                                     SPRITE_SIZE, SPRITE_SIZE };
+                Vector2 position = { static_cast<float>(rand() % SCR_WIDTH), static_cast<float>(rand() % SCR_HEIGHT) };
+                frame.sprites[i] = SpriteRect(source, position, position, {0, 0, 0, 0}, WHITE);
+        }
+        frame.length = count;
+}
+
+// Average milliseconds per frame, including the buffer swap so the GPU work is accounted for.
+template <typename DrawFn>
+static double measure(uint32_t frames, DrawFn draw) {
+        auto t0 = std::chrono::steady_clock::now();
+        for (uint32_t f = 0; f < frames; f++) {
+                BeginDrawing();
+                        ClearBackground(BLACK);
+                        draw();
+                EndDrawing();
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::milli>(t1 - t0).count() / frames;
+}
+
+int main(int argc, char** argv)
+{
+        uint32_t frames = (argc > 1) ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : DEFAULT_FRAMES;
+        srand(1);
+
+        SetConfigFlags(FLAG_WINDOW_HIDDEN);
+        SetTraceLogLevel(LOG_WARNING);
+        InitWindow(SCR_WIDTH, SCR_HEIGHT, "spritebench");
+        SetTargetFPS(0);
+
+        Texture2D textureAtlas = LoadTexture(FileSystem::getPath("player.png").c_str());
+        SpriteRectTripleBuffer *spriteRectTripleBuffer = new SpriteRectTripleBuffer(MAX_SPRITES);
+        SpriteBatch *spriteBatch = new SpriteBatch(textureAtlas, MAX_SPRITES);
+
+        printf("%10s %22s %22s\n", "sprites", "DrawTextureRec (ms)", "SpriteBatch (ms)");
+        for (uint32_t count : SPRITE_COUNTS) {
+                fillFrame(spriteRectTripleBuffer->producerFrame(), count, textureAtlas);
+                spriteRectTripleBuffer->publish();
+                const SpriteRectFrame& frame = spriteRectTripleBuffer->consumerFrame();
+
+                double perSprite = measure(frames, [&]() {
+                        for (uint32_t i = 0; i < frame.length; i++) {
+                                DrawTextureRec(textureAtlas, frame.sprites[i].source, frame.sprites[i].position, frame.sprites[i].tint);
+                        }
+                });
+
+                double batched = measure(frames, [&]() {
+                        spriteBatch->Build(frame, 1.0f);
+                        spriteBatch->Draw();
+                });
+
+                printf("%10u %22.3f %22.3f\n", count, perSprite, batched);
+        }
+
+        delete spriteBatch;
+        delete spriteRectTripleBuffer;
+        UnloadTexture(textureAtlas);
+        CloseWindow();
+
+        return 0;
+}
@@ -0,0 +1,138 @@
+// State machine dispatch benchmark.
+//
+// Creates a Player with the regular EntityFactory/EntityDataManager and fires a scripted loop of events (key presses,
+// landings, collisions) on its 18-state map. Reports events and transitions per second, the number of states
+// visited and the heap allocations per transition (state functions included, e.g. the animation they load).
+//
+// Usage: ./statebench [events]
+
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include <defines.h>
+#include <entity_data_manager.h>
+#include <entity_factory.h>
+#include <entities/player.h>
+#include <bench/allocation_counter.h>
+
+const uint64_t DEFAULT_EVENTS = 10000000;
+
+typedef void (Player::*PlayerEvent)();
+
+// The hit states are left when their animation ends (Player::ShouldBeginAnimationLoopAgain), not through a trigger
+const PlayerEvent HIT_ANIMATION_END = nullptr;
+
+// Event loop going through the idle, run, jump, fall, hit and slip states in both directions. The fall states that
+// follow a running jump have no trigger leading to them, so 16 of the 18 states are reachable.
+const PlayerEvent eventScript[] = {
+        &Player::RightKeyPressed,            // Run right
+        &Player::UpKeyPressed,               // Jump run right
+        &Player::TopCollisionDuringJump,     // Fall jump run right
+        &Player::FallLanding,
+        &Player::JumpLanding,
+        &Player::RightKeyReleased,
+        &Player::UpKeyPressed,               // Jump idle right
+        &Player::LateralCollisionDuringJump,
+        &Player::JumpLanding,
+        &Player::FallLanding,
+        &Player::DownKeyPressed,             // Fall idle right
+        &Player::FallLanding,
+        &Player::SpaceKeyPressed,            // Hit right
+        HIT_ANIMATION_END,
+        &Player::UpKeyPressed,
+        &Player::RightKeyPressedAtJumpApex,  // Fall run right
+        &Player::FallLanding,
+        &Player::RightKeyPressed,
+        &Player::StopRunningOnSlidingSurface, // Slip right
+        &Player::StopSlipping,
+        &Player::RightKeyPressed,
+        &Player::SuspendedInTheAir,          // Fall run right
+        &Player::FallLanding,
+        &Player::LeftKeyPressed,             // Run left
+        &Player::UpKeyPressed,               // Jump run left
+        &Player::TopCollisionDuringJump,     // Fall jump run left
+        &Player::FallLanding,
+        &Player::JumpLanding,
+        &Player::LeftKeyReleased,
+        &Player::UpKeyPressed,               // Jump idle left
+        &Player::LateralCollisionDuringJump,
+        &Player::JumpLanding,
+        &Player::FallLanding,
+        &Player::DownKeyPressed,             // Fall idle left
+        &Player::FallLanding,
+        &Player::SpaceKeyPressed,            // Hit left
+        HIT_ANIMATION_END,
+        &Player::UpKeyPressed,
+        &Player::LeftKeyPressedAtJumpApex,   // Fall run left
+        &Player::FallLanding,
+        &Player::LeftKeyPressed,
+        &Player::StopRunningOnSlidingSurface, // Slip left
+        &Player::StopSlipping,
+        &Player::LeftKeyPressed,
+        &Player::SuspendedInTheAir,          // Fall run left
+        &Player::FallLanding,
+        &Player::RightKeyPressed,
+        &Player::RightKeyReleased,
+};
+
+const size_t EVENT_SCRIPT_LENGTH = sizeof(eventScript) / sizeof(eventScript[0]);
+
+int main(int argc, char** argv)
+{
+        uint64_t events = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : DEFAULT_EVENTS;
+
+        // The state functions log to stdout; point it to /dev/null while they run.
+        fflush(stdout);
+        int savedStdout = dup(STDOUT_FILENO);
+        int nullFd = open("/dev/null", O_WRONLY);
+        dup2(nullFd, STDOUT_FILENO);
+        close(nullFd);
+
+        EntityDataManager *entityDataManager = new EntityDataManager();
+        std::optional<IEntity*> entity = EntityFactory::Get(nullptr, entityDataManager, nullptr)->CreateEntity(EntityIdentificator::POPO);
+        Player *player = static_cast<Player*>(*entity);
+
+        bool visited[256] = {};
+        uint64_t transitions = 0;
+        uint64_t allocationsBefore = allocations;
+        auto t0 = std::chrono::steady_clock::now();
+        for (uint64_t k = 0; k < events; k++) {
+                unsigned char previousState = player->GetCurrentState();
+                PlayerEvent event = eventScript[k % EVENT_SCRIPT_LENGTH];
+                if (event != HIT_ANIMATION_END) {
+                        (player->*event)();
+                } else {
+                        player->ShouldBeginAnimationLoopAgain();
+                }
+                unsigned char state = player->GetCurrentState();
+                if (state != previousState) {
+                        transitions++;
+                        visited[state] = true;
+                }
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        uint64_t transitionAllocations = allocations - allocationsBefore;
+
+        std::cout.flush();
+        fflush(stdout);
+        dup2(savedStdout, STDOUT_FILENO);
+        close(savedStdout);
+
+        int visitedStates = 0;
+        for (bool v : visited) visitedStates += v;
+
+        double seconds = std::chrono::duration<double>(t1 - t0).count();
+        printf("events:        %llu\n", static_cast<unsigned long long>(events));
+        printf("transitions:   %llu\n", static_cast<unsigned long long>(transitions));
+        printf("states:        %d\n", visitedStates);
+        printf("events/sec:    %.1f\n", seconds > 0.0 ? events / seconds : 0.0);
+        printf("transitions/sec: %.1f\n", seconds > 0.0 ? transitions / seconds : 0.0);
+        printf("allocs/transition: %.2f\n", transitions > 0 ? static_cast<double>(transitionAllocations) / transitions : 0.0);
+
+        EntityFactory::Get(nullptr, entityDataManager, nullptr)->DestroyEntity(player);
+        delete entityDataManager;
+        return 0;
+}
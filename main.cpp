@@ -1,7 +1,9 @@
 #include <iostream>
 #include <vector>
 #include <cmath>
-#include <mutex>
+#include <chrono>
+#include <atomic>
+#include <algorithm>
 #include <pthread.h>
 #include <thread>
 #include <bitset>
@@ -9,62 +11,104 @@
 #include <defines.h>
 #include <entity_data_manager.h>
 #include <entity_manager.h>
+#include <broadphase.h>
+#include <sprite_batch.h>
+#include <terrain_cache.h>
 
 const float ZOOM = 1.0f;
 const uint32_t SCR_WIDTH = 1280;
-const uint32_t SCR_HEIGHT = 30*CELL_HEIGHT*ZOOM; // REVISIT: The height should be a fixed value and the zoom value should be calculated based on the screen height.
+const uint32_t SCR_HEIGHT = VIEWPORT_HEIGHT_CELLS*CELL_HEIGHT*ZOOM; // REVISIT: The height should be a fixed value and the zoom value should be calculated based on the screen height.
 const uint32_t MAX_OBJECTS = 1000;
 
 pthread_t gameLogicThread;
-std::chrono::duration<float> cpuTimePerUpdate;
-uint8_t pressedKeys = IC_KEY_NONE;
-bool running = true;
+const std::chrono::steady_clock::duration TICK_DURATION = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / TICKS_PER_SECOND));
+InputQueue *inputQueue;
+std::atomic<bool> running{true};
 EntityDataManager *entityTextureManager;
 EntityManager *entityManager;
-int gameLogicFrequency = 16; // 16 milliseconds ≈ 60 ticks per second
 int framesPerSecond = 60;
-bool paused = false;
-float cameraVerticalPosition = -1.0f;  // Negative value means no position has been set
-std::mutex cameraVerticalPositionMutex;
+std::atomic<bool> paused{false};
 
+// Runs the game logic at a fixed rate of TICKS_PER_SECOND using a time accumulator. When the thread falls behind,
+// up to MAX_CATCH_UP_TICKS ticks are run back to back and any remaining backlog is dropped.
 static void* gameLogicThreadFunc(void* v)
 {
-        std::optional<float> optCameraVerticalPosition;
+        std::chrono::steady_clock::duration accumulator = std::chrono::steady_clock::duration::zero();
+        std::chrono::steady_clock::time_point previousTime = std::chrono::steady_clock::now();
+
         while(running) {
-                if (!paused) {
-                        auto t0 = std::chrono::high_resolution_clock::now();
-                        optCameraVerticalPosition = entityManager->Update(pressedKeys);
-                        cameraVerticalPositionMutex.lock();
-                        cameraVerticalPosition = optCameraVerticalPosition.value_or(-1.0f);
-                        cameraVerticalPositionMutex.unlock();
-                        auto t1 = std::chrono::high_resolution_clock::now();
-                        cpuTimePerUpdate = t1 - t0;
+                std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+                accumulator += now - previousTime;
+                previousTime = now;
+
+                if (paused) {
+                        accumulator = std::chrono::steady_clock::duration::zero();
                 }
-                std::this_thread::sleep_for(std::chrono::milliseconds(gameLogicFrequency) - cpuTimePerUpdate);
+
+                int ticks = 0;
+                while (accumulator >= TICK_DURATION && ticks < MAX_CATCH_UP_TICKS) {
+                        entityManager->Update();
+                        accumulator -= TICK_DURATION;
+                        ticks++;
+                }
+
+                if (accumulator >= TICK_DURATION) {
+                        accumulator %= TICK_DURATION; // Too far behind: drop the backlog instead of spiralling
+                }
+
+                std::this_thread::sleep_until(now + (TICK_DURATION - accumulator));
         }
         return nullptr;
 }
 
+// Fraction of a tick elapsed since the last published frame, used to interpolate between the previous and current tick.
+inline float interpolationAlpha(std::chrono::steady_clock::time_point frameTimestamp) {
+        float alpha = std::chrono::duration<float>(std::chrono::steady_clock::now() - frameTimestamp) / TICK_DURATION;
+        return std::clamp(alpha, 0.0f, 1.0f);
+}
+
+inline float lerp(float previous, float current, float alpha) {
+        return previous + (current - previous) * alpha;
+}
+
+// Forwards the keyboard edges to the game logic thread. Each press and release is queued with its capture time.
+inline void processKey(int key, uint8_t gameKey) {
+        if (IsKeyPressed(key)) inputQueue->push(gameKey, true);
+        if (IsKeyReleased(key)) inputQueue->push(gameKey, false);
+}
+
 inline void processInput() {
-        if (IsKeyPressed(KEY_RIGHT) || IsKeyReleased(KEY_RIGHT)) pressedKeys ^= IC_KEY_RIGHT;
-        if (IsKeyPressed(KEY_LEFT) || IsKeyReleased(KEY_LEFT)) pressedKeys ^= IC_KEY_LEFT;
-        if (IsKeyPressed(KEY_UP) || IsKeyReleased(KEY_UP)) pressedKeys ^= IC_KEY_UP;
-        if (IsKeyPressed(KEY_DOWN) || IsKeyReleased(KEY_DOWN)) pressedKeys ^= IC_KEY_DOWN;
-        if (IsKeyPressed(KEY_Q) || IsKeyReleased(KEY_Q)) pressedKeys ^= IC_KEY_Q;
-        if (IsKeyPressed(KEY_W) || IsKeyReleased(KEY_W)) pressedKeys ^= IC_KEY_W;
-        if (IsKeyPressed(KEY_A) || IsKeyReleased(KEY_A)) pressedKeys ^= IC_KEY_A;
-        if (IsKeyPressed(KEY_SPACE) || IsKeyReleased(KEY_SPACE)) pressedKeys ^= IC_KEY_SPACE;
-        if (IsKeyPressed(KEY_ESCAPE) || IsKeyReleased(KEY_ESCAPE)) pressedKeys ^= IC_KEY_DOWN;
-
-        if (IsKeyPressed(KEY_P)) gameLogicFrequency += 10;
-        if (IsKeyPressed(KEY_O)) gameLogicFrequency -= 10;
+        processKey(KEY_RIGHT, IC_KEY_RIGHT);
+        processKey(KEY_LEFT, IC_KEY_LEFT);
+        processKey(KEY_UP, IC_KEY_UP);
+        processKey(KEY_DOWN, IC_KEY_DOWN);
+        processKey(KEY_Q, IC_KEY_Q);
+        processKey(KEY_W, IC_KEY_W);
+        processKey(KEY_A, IC_KEY_A);
+        processKey(KEY_SPACE, IC_KEY_SPACE);
+        processKey(KEY_ESCAPE, IC_KEY_DOWN);
+
+        // Change the display rate only. The game logic always runs at TICKS_PER_SECOND.
+        if (IsKeyPressed(KEY_P)) SetTargetFPS(framesPerSecond += 60);
+        if (IsKeyPressed(KEY_O) && framesPerSecond > 60) SetTargetFPS(framesPerSecond -= 60);
         if (IsKeyPressed(KEY_M)) paused = !paused;
 }
 
-int main()
+int main(int argc, char** argv)
 {
         srand(static_cast<unsigned>(time(0))); // Initialize the random seed to avoid deterministic behaviours. Just for debug purposes.
 
+        // Collision broadphase backend, selectable at startup: ./main [tree|bvh|sapx|sapy]
+        BroadphaseType broadphaseType = BROADPHASE_BVH;
+        if (argc > 1) {
+                std::optional<BroadphaseType> requestedBroadphase = BroadphaseTypeFromName(argv[1]);
+                if (!requestedBroadphase.has_value()) {
+                        std::cerr << "Unknown broadphase: " << argv[1] << std::endl;
+                        return 1;
+                }
+                broadphaseType = *requestedBroadphase;
+        }
+
         InitWindow(SCR_WIDTH, SCR_HEIGHT, "Ice Climber");
 
         Camera2D camera = { 0 };
@@ -76,13 +120,25 @@ int main()
         SetTargetFPS(framesPerSecond);
 
         entityTextureManager = new EntityDataManager();
-        SpriteRectDoubleBuffer *spriteRectDoubleBuffer = new SpriteRectDoubleBuffer(MAX_OBJECTS);
-        entityManager = new EntityManager(entityTextureManager, spriteRectDoubleBuffer, MAX_OBJECTS);
+        SpriteRectTripleBuffer *spriteRectTripleBuffer = new SpriteRectTripleBuffer(MAX_OBJECTS);
+        inputQueue = new InputQueue();
+        entityManager = new EntityManager(entityTextureManager, spriteRectTripleBuffer, inputQueue, MAX_OBJECTS, broadphaseType);
+        if (!entityManager->IsLoaded()) {
+                std::cerr << "Unable to load the mountain " << MOUNTAIN_FILENAME << std::endl;
+                delete entityManager;
+                delete entityTextureManager;
+                delete spriteRectTripleBuffer;
+                delete inputQueue;
+                CloseWindow();
+                return 1;
+        }
 
         // Load texture atlas into GPU memory
         Texture2D textureAtlas = entityTextureManager->LoadTextureAtlas();
+        SpriteBatch *spriteBatch = new SpriteBatch(textureAtlas, MAX_OBJECTS);
+        TerrainCache *terrainCache = new TerrainCache(textureAtlas);
 
-        entityManager->Update(pressedKeys);
+        entityManager->Update();
 
         pthread_create(&gameLogicThread, nullptr, gameLogicThreadFunc, nullptr);
 
@@ -92,25 +148,22 @@ int main()
                 BeginDrawing();
                         ClearBackground(BLACK);
 
-                        cameraVerticalPositionMutex.lock();
-                        if (cameraVerticalPosition > 0.0f) {
-                                camera.offset = (Vector2){ 0, -cameraVerticalPosition * ZOOM };
-                        }
-                        cameraVerticalPositionMutex.unlock();
+                        const SpriteRectFrame& frame = spriteRectTripleBuffer->consumerFrame();
+                        float alpha = interpolationAlpha(frame.timestamp);
+                        camera.offset = (Vector2){ 0, -lerp(frame.previousCameraPosition, frame.cameraPosition, alpha) * ZOOM };
+                        terrainCache->Update(frame);
 
                         BeginMode2D(camera);
-                                spriteRectDoubleBuffer->lock();
-                                for(int i=0; i<spriteRectDoubleBuffer->consumer_buffer_length; i++) {
-                                        auto position = spriteRectDoubleBuffer->consumer_buffer[i].position;
-                                        auto source = spriteRectDoubleBuffer->consumer_buffer[i].source;
-                                        auto tint = spriteRectDoubleBuffer->consumer_buffer[i].tint;
-                                        DrawTextureRec(textureAtlas, source, position, tint);
-
-                                        //auto box = spriteRectDoubleBuffer->consumer_buffer[i].boundaries;
-                                        //DrawRectangleLinesEx({static_cast<float>(box.upperBoundX), static_cast<float>(box.upperBoundY), static_cast<float>(box.lowerBoundX-box.upperBoundX), static_cast<float>(box.lowerBoundY-box.upperBoundY)}, 1.0f, PINK);
-                                }
-                                spriteRectDoubleBuffer->unlock();
+                                terrainCache->Draw(frame);
+                                spriteBatch->Build(frame, alpha);
+                                spriteBatch->Draw();
+
+                                //for(int i=0; i<frame.length; i++) {
+                                //        auto box = frame.sprites[i].boundaries;
+                                //        DrawRectangleLinesEx({static_cast<float>(box.upperBoundX), static_cast<float>(box.upperBoundY), static_cast<float>(box.lowerBoundX-box.upperBoundX), static_cast<float>(box.lowerBoundY-box.upperBoundY)}, 1.0f, PINK);
+                                //}
                                 DrawFPS(535, 110);
+                                DrawText(TextFormat("Input latency: %.2f ms", frame.inputLatency), 535, 130, 10, LIME);
                         EndMode2D();
                 EndDrawing();
         }
@@ -122,7 +175,10 @@ int main()
 
         delete entityTextureManager;
         delete entityManager;
-        delete spriteRectDoubleBuffer;
+        delete spriteRectTripleBuffer;
+        delete inputQueue;
+        delete spriteBatch;
+        delete terrainCache;
         UnloadTexture(textureAtlas);
         CloseWindow();
 
@@ -0,0 +1,53 @@
+#include <animation_scheduler.h>
+
+AnimationScheduler::AnimationScheduler() : slots(WHEEL_SIZE) {
+}
+
+bool AnimationScheduler::remove(IEntity* entity, uint64_t dueTick) {
+  if (dueTick == 0) {
+    return false;
+  }
+
+  std::vector<Timer>& slot = slots[dueTick & (WHEEL_SIZE - 1)];
+  for (size_t k = 0; k < slot.size(); k++) {
+    if (slot[k].entity == entity) {
+      slot[k] = slot.back();
+      slot.pop_back();
+      size--;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Replaces the pending wake up of the object, if any, with one at dueTick. Objects are woken up at the earliest by the
+// next call to Advance. Returns the tick of the new wake up.
+uint64_t AnimationScheduler::Schedule(IEntity* entity, uint64_t pendingTick, uint64_t dueTick) {
+  remove(entity, pendingTick);
+  if (dueTick <= currentTick) {
+    dueTick = currentTick + 1;
+  }
+  slots[dueTick & (WHEEL_SIZE - 1)].push_back({ entity, dueTick });
+  size++;
+  return dueTick;
+}
+
+void AnimationScheduler::Cancel(IEntity* entity, uint64_t pendingTick) {
+  remove(entity, pendingTick);
+}
+
+// Appends the objects due at the given tick, which must follow the previous one.
+void AnimationScheduler::Advance(uint64_t tick, std::vector<IEntity*>& due) {
+  currentTick = tick;
+  std::vector<Timer>& slot = slots[tick & (WHEEL_SIZE - 1)];
+  for (size_t k = 0; k < slot.size();) {
+    if (slot[k].dueTick <= tick) {
+      due.push_back(slot[k].entity);
+      slot[k] = slot.back();
+      slot.pop_back();
+      size--;
+    } else {
+      k++;
+    }
+  }
+}
@@ -0,0 +1,32 @@
+#ifndef ANIMATION_SCHEDULER_H
+#define ANIMATION_SCHEDULER_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+class IEntity;
+
+// Timer wheel waking up the objects whose next animation frame is due. An object has at most one pending wake up,
+// stored in the slot of its tick; wake ups more than WHEEL_SIZE ticks away stay in their slot for the following turns
+// of the wheel. Wake up ticks start at 1, so 0 stands for no pending wake up.
+class AnimationScheduler {
+  struct Timer { IEntity* entity; uint64_t dueTick; };
+
+  std::vector<std::vector<Timer>> slots;
+  uint64_t currentTick = 0;
+  size_t size = 0;
+
+  bool remove(IEntity*, uint64_t);
+
+public:
+  static constexpr uint32_t WHEEL_SIZE = 64; // Power of two, about one second of ticks
+
+  AnimationScheduler();
+  uint64_t Schedule(IEntity*, uint64_t, uint64_t);
+  void Cancel(IEntity*, uint64_t);
+  void Advance(uint64_t, std::vector<IEntity*>&);
+  size_t Size() const { return size; }
+};
+
+#endif
@@ -0,0 +1,280 @@
+#include <asset_cache.h>
+#include <defines.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static const char ASSET_CACHE_MAGIC[8] = { 'I', 'C', 'A', 'S', 'S', 'E', 'T', '\0' };
+static const size_t SPRITE_VALUES = 13; // Values of a sprite line of the text file
+
+// FNV-1a
+uint32_t AssetChecksum(const uint8_t *data, size_t length) {
+  uint32_t hash = 2166136261u;
+  for (size_t k = 0; k < length; k++) {
+    hash = (hash ^ data[k]) * 16777619u;
+  }
+  return hash;
+}
+
+// Modification time (nanoseconds, so an edit within the same second is seen) and size of a file
+bool AssetFileStatus(const std::string& path, int64_t& time, uint64_t& size) {
+  struct stat status;
+  if (stat(path.c_str(), &status) != 0) {
+    return false;
+  }
+#ifdef __APPLE__
+  const struct timespec& modificationTime = status.st_mtimespec;
+#else
+  const struct timespec& modificationTime = status.st_mtim;
+#endif
+  time = static_cast<int64_t>(modificationTime.tv_sec) * 1000000000 + modificationTime.tv_nsec;
+  size = static_cast<uint64_t>(status.st_size);
+  return true;
+}
+
+static bool startsWith(const std::string& line, size_t begin, size_t end, const char *prefix) {
+  size_t length = std::strlen(prefix);
+  return end - begin >= length && line.compare(begin, length, prefix) == 0;
+}
+
+AssetTables CompiledAssets::Tables() const {
+  AssetTables tables;
+  tables.sheets = sheets.data();
+  tables.animations = animations.data();
+  tables.frames = frames.data();
+  tables.areas = areas.data();
+  tables.sheetCount = static_cast<uint32_t>(sheets.size());
+  tables.animationCount = static_cast<uint32_t>(animations.size());
+  tables.frameCount = static_cast<uint32_t>(frames.size());
+  tables.areaCount = static_cast<uint32_t>(areas.size());
+  tables.textureFilename = textureFilename.data();
+  tables.textureFilenameLength = static_cast<uint32_t>(textureFilename.size());
+  return tables;
+}
+
+// Parses the text file. Each line is a texture filename (###file), a sprite sheet (##entity id), an animation
+// (#animation id), a sprite (13 values) or a collision area of the previous sprite (_id solid|simple x y x y ...).
+// Anything after // is a comment.
+bool CompileAssets(const std::string& sourcePath, CompiledAssets& assets) {
+  std::ifstream infile(sourcePath);
+  if (!infile) {
+    return false;
+  }
+
+  std::string line;
+  size_t tokens[SPRITE_VALUES];
+  while (std::getline(infile, line)) {
+    size_t valueCount = 0;
+    size_t position = 0;
+    while (true) {
+      size_t begin = line.find_first_not_of(" \t\r", position);
+      if (begin == std::string::npos) break;
+      size_t end = std::min(line.find_first_of(" \t\r", begin), line.size());
+      position = end;
+      const char *token = line.c_str() + begin;
+
+      if (startsWith(line, begin, end, "//")) {
+        break;
+      } else if (startsWith(line, begin, end, "###")) {
+        assets.textureFilename = line.substr(begin + 3, end - begin - 3);
+      } else if (startsWith(line, begin, end, "##")) {
+        assets.sheets.push_back({ static_cast<uint32_t>(std::atoi(token + 2)), static_cast<uint32_t>(assets.animations.size()), 0 });
+      } else if (startsWith(line, begin, end, "#")) {
+        if (!assets.sheets.empty()) {
+          assets.animations.push_back({ static_cast<uint32_t>(std::atoi(token + 1)), static_cast<uint32_t>(assets.frames.size()), 0 });
+          assets.sheets.back().animationCount++;
+        }
+      } else if (startsWith(line, begin, end, "_")) {
+        // The rest of the line is the type and the points of the area, kept as the box around the points
+        AssetArea area = { static_cast<uint32_t>(std::atoi(token + 1)), 0.0f, 0.0f, 0.0f, 0.0f };
+        size_t typeBegin = std::min(line.find_first_not_of(" \t\r", end), line.size());
+        size_t typeEnd = std::min(line.find_first_of(" \t\r", typeBegin), line.size());
+        bool isSolid = startsWith(line, typeBegin, typeEnd, "solid");
+        bool isSimple = startsWith(line, typeBegin, typeEnd, "simple");
+
+        char *cursor = const_cast<char*>(line.c_str()) + typeEnd;
+        for (bool first = true; ; first = false) {
+          char *afterX, *afterY;
+          float x = std::strtof(cursor, &afterX);
+          float y = std::strtof(afterX, &afterY);
+          if (afterX == cursor || afterY == afterX) break;
+          cursor = afterY;
+          area.lowerX = first ? x : std::min(area.lowerX, x);
+          area.lowerY = first ? y : std::min(area.lowerY, y);
+          area.upperX = first ? x : std::max(area.upperX, x);
+          area.upperY = first ? y : std::max(area.upperY, y);
+        }
+
+        if ((isSolid || isSimple) && !assets.frames.empty()) {
+          AssetFrame& frame = assets.frames.back();
+          if (isSolid) {
+            assets.areas.insert(assets.areas.begin() + frame.firstArea + frame.solidAreaCount, area);
+            frame.solidAreaCount++;
+          } else {
+            assets.areas.push_back(area);
+            frame.simpleAreaCount++;
+          }
+        }
+        break;
+      } else if (valueCount < SPRITE_VALUES) {
+        tokens[valueCount++] = begin;
+      } else {
+        valueCount++;
+      }
+    }
+
+    if (valueCount == SPRITE_VALUES && !assets.animations.empty()) {
+      const char *values = line.c_str();
+      AssetFrame frame;
+      frame.width = std::atoi(values + tokens[0]);
+      frame.height = std::atoi(values + tokens[1]);
+      frame.xOffset = std::atoi(values + tokens[2]);
+      frame.yOffset = std::atoi(values + tokens[3]);
+      frame.u1 = std::strtof(values + tokens[4], nullptr);
+      frame.v1 = std::strtof(values + tokens[5], nullptr);
+      frame.u2 = std::strtof(values + tokens[6], nullptr);
+      frame.v2 = std::strtof(values + tokens[7], nullptr);
+
+      // Animations advance with the game logic ticks, at least one tick per sprite
+      int duration = std::atoi(values + tokens[8]); // Milliseconds
+      frame.durationTicks = std::max(1, (duration * TICKS_PER_SECOND + 500) / 1000);
+
+      frame.lowerBoundX = std::atoi(values + tokens[9]);
+      frame.lowerBoundY = std::atoi(values + tokens[10]);
+      frame.upperBoundX = std::atoi(values + tokens[11]);
+      frame.upperBoundY = std::atoi(values + tokens[12]);
+      frame.firstArea = static_cast<uint32_t>(assets.areas.size());
+      frame.solidAreaCount = 0;
+      frame.simpleAreaCount = 0;
+      assets.frames.push_back(frame);
+      assets.animations.back().frameCount++;
+    }
+  }
+
+  return true;
+}
+
+template <class T>
+static void appendTable(std::vector<uint8_t>& payload, const std::vector<T>& table) {
+  const uint8_t *bytes = reinterpret_cast<const uint8_t*>(table.data());
+  payload.insert(payload.end(), bytes, bytes + table.size() * sizeof(T));
+}
+
+// Writes the tables next to the text file they were compiled from. The file is written aside and renamed, so a
+// reader never maps a partial cache.
+bool WriteAssetCache(const std::string& cachePath, const std::string& sourcePath, const CompiledAssets& assets) {
+  AssetCacheHeader header = {};
+  std::memcpy(header.magic, ASSET_CACHE_MAGIC, sizeof(header.magic));
+  header.version = ASSET_CACHE_VERSION;
+  if (!AssetFileStatus(sourcePath, header.sourceModificationTime, header.sourceSize)) {
+    return false;
+  }
+  header.ticksPerSecond = TICKS_PER_SECOND;
+  header.sheetCount = static_cast<uint32_t>(assets.sheets.size());
+  header.animationCount = static_cast<uint32_t>(assets.animations.size());
+  header.frameCount = static_cast<uint32_t>(assets.frames.size());
+  header.areaCount = static_cast<uint32_t>(assets.areas.size());
+  header.textureFilenameLength = static_cast<uint32_t>(assets.textureFilename.size());
+
+  std::vector<uint8_t> payload;
+  appendTable(payload, assets.sheets);
+  appendTable(payload, assets.animations);
+  appendTable(payload, assets.frames);
+  appendTable(payload, assets.areas);
+  payload.insert(payload.end(), assets.textureFilename.begin(), assets.textureFilename.end());
+  header.checksum = AssetChecksum(payload.data(), payload.size());
+
+  std::string temporaryPath = cachePath + ".tmp";
+  FILE *file = std::fopen(temporaryPath.c_str(), "wb");
+  if (file == nullptr) {
+    return false;
+  }
+  bool written = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+                 (payload.empty() || std::fwrite(payload.data(), payload.size(), 1, file) == 1);
+  written = (std::fclose(file) == 0) && written;
+  if (!written || std::rename(temporaryPath.c_str(), cachePath.c_str()) != 0) {
+    std::remove(temporaryPath.c_str());
+    return false;
+  }
+  return true;
+}
+
+MappedAssetCache::~MappedAssetCache() {
+  Close();
+}
+
+void MappedAssetCache::Close() {
+  if (mapping != nullptr) {
+    munmap(mapping, mappingSize);
+  }
+  mapping = nullptr;
+  mappingSize = 0;
+  tables = AssetTables();
+}
+
+bool MappedAssetCache::Open(const std::string& cachePath, const std::string& sourcePath) {
+  Close();
+
+  int64_t sourceTime = 0;
+  uint64_t cacheSize = 0, sourceSize = 0;
+  struct stat status;
+  if (stat(cachePath.c_str(), &status) != 0 || static_cast<uint64_t>(status.st_size) < sizeof(AssetCacheHeader)) {
+    return false;
+  }
+  cacheSize = static_cast<uint64_t>(status.st_size);
+
+  // The cache can be shipped without the text file. When both exist, the cache must come from the current text file.
+  bool hasSource = AssetFileStatus(sourcePath, sourceTime, sourceSize);
+
+  int fd = open(cachePath.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  void *address = mmap(nullptr, cacheSize, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (address == MAP_FAILED) {
+    return false;
+  }
+  mapping = address;
+  mappingSize = cacheSize;
+
+  const uint8_t *bytes = static_cast<const uint8_t*>(mapping);
+  const AssetCacheHeader *header = reinterpret_cast<const AssetCacheHeader*>(bytes);
+  size_t expectedSize = sizeof(AssetCacheHeader) +
+                        header->sheetCount * sizeof(AssetSpriteSheet) + header->animationCount * sizeof(AssetAnimation) +
+                        header->frameCount * sizeof(AssetFrame) + header->areaCount * sizeof(AssetArea) +
+                        header->textureFilenameLength;
+  bool valid = std::memcmp(header->magic, ASSET_CACHE_MAGIC, sizeof(header->magic)) == 0 &&
+               header->version == ASSET_CACHE_VERSION &&
+               header->ticksPerSecond == static_cast<uint32_t>(TICKS_PER_SECOND) &&
+               (!hasSource || (header->sourceSize == sourceSize && header->sourceModificationTime == sourceTime)) &&
+               expectedSize == mappingSize &&
+               header->checksum == AssetChecksum(bytes + sizeof(AssetCacheHeader), mappingSize - sizeof(AssetCacheHeader));
+  if (!valid) {
+    Close();
+    return false;
+  }
+
+  const uint8_t *table = bytes + sizeof(AssetCacheHeader);
+  tables.sheets = reinterpret_cast<const AssetSpriteSheet*>(table);
+  table += header->sheetCount * sizeof(AssetSpriteSheet);
+  tables.animations = reinterpret_cast<const AssetAnimation*>(table);
+  table += header->animationCount * sizeof(AssetAnimation);
+  tables.frames = reinterpret_cast<const AssetFrame*>(table);
+  table += header->frameCount * sizeof(AssetFrame);
+  tables.areas = reinterpret_cast<const AssetArea*>(table);
+  table += header->areaCount * sizeof(AssetArea);
+  tables.textureFilename = reinterpret_cast<const char*>(table);
+  tables.sheetCount = header->sheetCount;
+  tables.animationCount = header->animationCount;
+  tables.frameCount = header->frameCount;
+  tables.areaCount = header->areaCount;
+  tables.textureFilenameLength = header->textureFilenameLength;
+  return true;
+}
@@ -0,0 +1,83 @@
+#ifndef ASSET_CACHE_H
+#define ASSET_CACHE_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Compiled form of the entity types file (objtypes.dat): flat tables of sprite sheets, animations, frames and collision
+// areas, each record referencing a range of the next table. The binary cache is a header followed by the tables and the
+// texture filename, so it is used straight from the mapped file without any parsing.
+constexpr uint32_t ASSET_CACHE_VERSION = 3;
+
+struct AssetSpriteSheet { uint32_t entityId, firstAnimation, animationCount; };
+struct AssetAnimation { uint32_t animationId, firstFrame, frameCount; };
+struct AssetFrame {
+  int32_t width, height, xOffset, yOffset;
+  float u1, v1, u2, v2;
+  int32_t durationTicks;
+  int32_t lowerBoundX, lowerBoundY, upperBoundX, upperBoundY;
+  uint32_t firstArea, solidAreaCount, simpleAreaCount; // Solid areas first
+};
+struct AssetArea { uint32_t id; float lowerX, lowerY, upperX, upperY; }; // Box of the points of the area
+
+struct AssetCacheHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t checksum;         // FNV-1a of everything after the header
+  uint64_t sourceSize;       // Entity types file the cache was compiled from
+  int64_t sourceModificationTime; // Nanoseconds
+  uint32_t ticksPerSecond;   // Frame durations are stored in ticks
+  uint32_t sheetCount, animationCount, frameCount, areaCount;
+  uint32_t textureFilenameLength;
+  uint32_t reserved[2];
+};
+
+// Read only view of the compiled tables, either owned by CompiledAssets or mapped from the cache file.
+struct AssetTables {
+  const AssetSpriteSheet *sheets = nullptr;
+  const AssetAnimation *animations = nullptr;
+  const AssetFrame *frames = nullptr;
+  const AssetArea *areas = nullptr;
+  uint32_t sheetCount = 0, animationCount = 0, frameCount = 0, areaCount = 0;
+  const char *textureFilename = nullptr;
+  uint32_t textureFilenameLength = 0;
+};
+
+// Tables compiled from the text file.
+struct CompiledAssets {
+  std::vector<AssetSpriteSheet> sheets;
+  std::vector<AssetAnimation> animations;
+  std::vector<AssetFrame> frames;
+  std::vector<AssetArea> areas;
+  std::string textureFilename;
+  AssetTables Tables() const;
+};
+
+bool CompileAssets(const std::string&, CompiledAssets&);
+bool WriteAssetCache(const std::string&, const std::string&, const CompiledAssets&);
+
+// Shared with the other compiled data files (e.g. the mountains)
+uint32_t AssetChecksum(const uint8_t*, size_t);
+bool AssetFileStatus(const std::string&, int64_t&, uint64_t&);
+
+// Cache file mapped in memory. Open fails when the cache is missing, corrupt, written by another version or compiled
+// from another revision of the text file (size or modification time), which then has to be parsed again.
+class MappedAssetCache {
+  void *mapping = nullptr;
+  size_t mappingSize = 0;
+  AssetTables tables;
+
+public:
+  MappedAssetCache() = default;
+  ~MappedAssetCache();
+  MappedAssetCache(const MappedAssetCache&) = delete;
+  MappedAssetCache& operator=(const MappedAssetCache&) = delete;
+
+  bool Open(const std::string&, const std::string&);
+  void Close();
+  const AssetTables& Tables() const { return tables; }
+};
+
+#endif
@@ -0,0 +1,127 @@
+#include <algorithm>
+#include <broadphase.h>
+#include <entity.h>
+#include <broadphase/tree_broadphase.h>
+#include <broadphase/bvh_broadphase.h>
+#include <broadphase/sweep_and_prune_broadphase.h>
+
+void Broadphase::Changed(IEntity* particle) {
+  if (trackChanges && particle->broadphaseChangeStamp != changeStamp) {
+    particle->broadphaseChangeStamp = changeStamp;
+    changedParticles.push_back(particle);
+  }
+}
+
+bool Broadphase::HasChanged(const IEntity* particle) const {
+  return trackChanges && particle->broadphaseChangeStamp == changeStamp;
+}
+
+// The objects stamped during the previous pass no longer match the new stamp.
+void Broadphase::ClearChanges() {
+  changedParticles.clear();
+  changeStamp++;
+  trackChanges = true;
+}
+
+void Broadphase::InsertTerrain(IEntity* particle, const aabb::Bounds2i& bounds, uint16_t categories) {
+  InsertTerrainParticle(particle, bounds, categories);
+  Changed(particle);
+}
+
+void Broadphase::Insert(IEntity* particle, const aabb::Bounds2i& bounds, uint16_t categories) {
+  InsertParticle(particle, bounds, categories);
+  Changed(particle);
+}
+
+// Objects created during a tick are inserted together once all the objects are updated.
+void Broadphase::InsertBatch(const std::vector<BroadphaseInsertion>& insertions) {
+  InsertParticles(insertions);
+  for (auto const& insertion : insertions) {
+    Changed(insertion.particle);
+  }
+}
+
+void Broadphase::InsertParticles(const std::vector<BroadphaseInsertion>& insertions) {
+  for (auto const& insertion : insertions) {
+    if (insertion.isTerrain) {
+      InsertTerrainParticle(insertion.particle, insertion.bounds, insertion.categories);
+    } else {
+      InsertParticle(insertion.particle, insertion.bounds, insertion.categories);
+    }
+  }
+}
+
+void Broadphase::Update(IEntity* particle, const aabb::Bounds2i& bounds) {
+  if (UpdateParticle(particle, bounds)) {
+    Changed(particle);
+  }
+}
+
+void Broadphase::Remove(IEntity* particle) {
+  RemoveParticle(particle);
+  Changed(particle);
+}
+
+void Broadphase::CountQuery(const aabb::Bounds2i& bounds, uint16_t mask) {
+  queryCount++;
+  if (queryLog != nullptr && queryLog->size() < queryLog->capacity()) {
+    queryLog->push_back({ bounds, mask });
+  }
+}
+
+void Broadphase::QueryHits(const aabb::Bounds2i& bounds, std::vector<BroadphaseHit>& candidates, uint16_t mask) {
+  CountQuery(bounds, mask);
+  QueryCandidates(bounds, mask, candidates);
+}
+
+void Broadphase::Query(const aabb::Bounds2i& bounds, std::vector<aabb::AABBIntersection<IEntity*>>& intersections, uint16_t mask) {
+  CountQuery(bounds, mask);
+  hits.clear();
+  QueryCandidates(bounds, mask, hits);
+  size_t first = intersections.size();
+  for (auto const& hit : hits) {
+    intersections.push_back(hit.box.Intersection(hit.particle, bounds));
+  }
+  SortIntersections(intersections, first);
+}
+
+void SortIntersections(std::vector<aabb::AABBIntersection<IEntity*>>& intersections, size_t first) {
+  std::sort(intersections.begin() + first, intersections.end(),
+            [](const aabb::AABBIntersection<IEntity*>& a, const aabb::AABBIntersection<IEntity*>& b) {
+              IEntity* p = a.particle;
+              IEntity* q = b.particle;
+              if (p->Type() != q->Type()) return p->Type() < q->Type();
+              if (p->position.GetInitialCellY() != q->position.GetInitialCellY()) return p->position.GetInitialCellY() < q->position.GetInitialCellY();
+              if (p->position.GetInitialCellX() != q->position.GetInitialCellX()) return p->position.GetInitialCellX() < q->position.GetInitialCellX();
+              return p->uniqueId < q->uniqueId; // Objects created in the same cell, in creation order
+            });
+}
+
+static const char* broadphaseNames[BROADPHASE_TYPES] = { "tree", "bvh", "sapx", "sapy" };
+
+Broadphase* CreateBroadphase(BroadphaseType type) {
+  switch (type) {
+    case BROADPHASE_TREE:
+      return new TreeBroadphase();
+    case BROADPHASE_SWEEP_AND_PRUNE_X:
+      return new SweepAndPruneBroadphase(false);
+    case BROADPHASE_SWEEP_AND_PRUNE_Y:
+      return new SweepAndPruneBroadphase(true);
+    case BROADPHASE_BVH:
+    default:
+      return new BVHBroadphase();
+  }
+}
+
+const char* BroadphaseName(BroadphaseType type) {
+  return (type < BROADPHASE_TYPES) ? broadphaseNames[type] : "unknown";
+}
+
+std::optional<BroadphaseType> BroadphaseTypeFromName(const std::string& name) {
+  for (uint8_t type = 0; type < BROADPHASE_TYPES; type++) {
+    if (name == broadphaseNames[type]) {
+      return static_cast<BroadphaseType>(type);
+    }
+  }
+  return std::nullopt;
+}
@@ -0,0 +1,137 @@
+#ifndef BROADPHASE_H
+#define BROADPHASE_H
+
+#include <vector>
+#include <string>
+#include <optional>
+#include <cstdint>
+#include <AABB/AABB.h>
+
+class IEntity;
+
+enum BroadphaseType: uint8_t { BROADPHASE_TREE = 0, BROADPHASE_BVH = 1, BROADPHASE_SWEEP_AND_PRUNE_X = 2, BROADPHASE_SWEEP_AND_PRUNE_Y = 3 };
+constexpr uint8_t BROADPHASE_TYPES = 4;
+
+// Collision category of an object, stored in the broadphase with its box. Queries take a mask of the categories to
+// report, so rejected objects are skipped (or whole subtrees pruned) during the traversal.
+enum CollisionCategory: uint16_t {
+  COLLISION_CATEGORY_NONE = 0,
+  COLLISION_CATEGORY_SOLID = 1 << 0,   // Terrain blocking the actors (bricks)
+  COLLISION_CATEGORY_CLOUD = 1 << 1,   // Moving platforms
+  COLLISION_CATEGORY_SCENERY = 1 << 2, // Traversable terrain (water, side walls, texts)
+  COLLISION_CATEGORY_PLAYER = 1 << 3,
+  COLLISION_CATEGORY_TOPI = 1 << 4,
+  COLLISION_CATEGORY_ICE = 1 << 5,
+  COLLISION_CATEGORY_ALL = 0xFFFF
+};
+
+// Fattened box of an object, as stored by the backends. Objects are fattened by a skin proportional to their size and
+// the box is only refreshed when the object leaves it, like the AABB tree does, so every backend reports the same
+// intersection values.
+struct FatBox {
+  float lowerX, lowerY, upperX, upperY;
+
+  static FatBox Fatten(const aabb::Bounds2i& bounds, double skinThickness) {
+    FatBox box = { static_cast<float>(bounds.lowerX), static_cast<float>(bounds.lowerY),
+                   static_cast<float>(bounds.upperX), static_cast<float>(bounds.upperY) };
+    float sizeX = box.upperX - box.lowerX;
+    float sizeY = box.upperY - box.lowerY;
+    box.lowerX -= skinThickness * sizeX;
+    box.upperX += skinThickness * sizeX;
+    box.lowerY -= skinThickness * sizeY;
+    box.upperY += skinThickness * sizeY;
+    return box;
+  }
+
+  static FatBox FromAABB(const aabb::AABB& aabb) {
+    return { aabb.lowerBound[0], aabb.lowerBound[1], aabb.upperBound[0], aabb.upperBound[1] };
+  }
+
+  bool Contains(const aabb::Bounds2i& bounds) const {
+    return bounds.lowerX >= lowerX && bounds.upperX <= upperX && bounds.lowerY >= lowerY && bounds.upperY <= upperY;
+  }
+
+  // Touching boxes overlap
+  bool Overlaps(const aabb::Bounds2i& bounds) const {
+    return !(bounds.upperX < lowerX || bounds.lowerX > upperX || bounds.upperY < lowerY || bounds.lowerY > upperY);
+  }
+
+  aabb::AABBIntersection<IEntity*> Intersection(IEntity* particle, const aabb::Bounds2i& bounds) const {
+    return { particle,
+             static_cast<int>(upperX - bounds.lowerX), static_cast<int>(lowerX - bounds.upperX),
+             static_cast<int>(upperY - bounds.lowerY), static_cast<int>(lowerY - bounds.upperY) };
+  }
+};
+
+// Object found by a broadphase query, with its fattened box.
+struct BroadphaseHit { IEntity* particle; FatBox box; };
+
+// Object inserted by InsertBatch. Terrain objects are inserted as with InsertTerrain.
+struct BroadphaseInsertion { IEntity* particle; aabb::Bounds2i bounds; uint16_t categories; bool isTerrain; };
+
+// Box and category mask of a query, as recorded by LogQueries.
+struct BroadphaseQuery { aabb::Bounds2i bounds; uint16_t mask; };
+
+// Collision broadphase: finds the objects whose fattened box overlaps a given box. The motionless terrain of the
+// mountain is inserted with InsertTerrain and BuildTerrain is called whenever bands of the mountain are created or
+// deleted, so the backends can bulk build it. The objects inserted, moved or removed since the last ClearChanges are recorded, so the tick pair list
+// (see BroadphasePairs) knows which of its boxes are stale.
+class Broadphase {
+  uint64_t queryCount = 0;
+  std::vector<BroadphaseQuery>* queryLog = nullptr;
+  std::vector<BroadphaseHit> hits; // Reused by Query
+  std::vector<IEntity*> changedParticles;
+  uint64_t changeStamp = 0;  // Pass since the last ClearChanges, stamped on the changed objects
+  bool trackChanges = false; // Off while the mountain is created
+
+  void Changed(IEntity*);
+  void CountQuery(const aabb::Bounds2i&, uint16_t);
+
+protected:
+  static constexpr double SKIN_THICKNESS = 0.05;
+  virtual void InsertTerrainParticle(IEntity* particle, const aabb::Bounds2i& bounds, uint16_t categories) {
+    InsertParticle(particle, bounds, categories);
+  }
+  virtual void InsertParticle(IEntity*, const aabb::Bounds2i&, uint16_t) = 0;
+  virtual void InsertParticles(const std::vector<BroadphaseInsertion>&);
+  virtual bool UpdateParticle(IEntity*, const aabb::Bounds2i&) = 0; // True when the fattened box was refreshed
+  virtual void RemoveParticle(IEntity*) = 0;
+  virtual void QueryCandidates(const aabb::Bounds2i&, uint16_t, std::vector<BroadphaseHit>&) = 0;
+
+public:
+  virtual ~Broadphase() {}
+  virtual void BuildTerrain() {}
+  void InsertTerrain(IEntity*, const aabb::Bounds2i&, uint16_t);
+  void Insert(IEntity*, const aabb::Bounds2i&, uint16_t);
+  void InsertBatch(const std::vector<BroadphaseInsertion>&);
+  void Update(IEntity*, const aabb::Bounds2i&);
+  void Remove(IEntity*);
+
+  // Append the objects (with their fattened box) or the intersections (sorted by SortIntersections) to a caller-owned
+  // buffer. Only the objects of the categories in the mask are reported.
+  void QueryHits(const aabb::Bounds2i&, std::vector<BroadphaseHit>&, uint16_t mask = COLLISION_CATEGORY_ALL);
+  void Query(const aabb::Bounds2i&, std::vector<aabb::AABBIntersection<IEntity*>>&, uint16_t mask = COLLISION_CATEGORY_ALL);
+
+  // Current fattened box of an object, if it is in the broadphase.
+  virtual std::optional<FatBox> GetBox(IEntity*) = 0;
+
+  const std::vector<IEntity*>& ChangedParticles() const { return changedParticles; }
+  bool HasChanged(const IEntity*) const;
+  void ClearChanges();
+
+  uint64_t QueryCount() const { return queryCount; }
+
+  // Records the queried boxes until the buffer reaches its capacity (it never grows, so logging does not allocate).
+  void LogQueries(std::vector<BroadphaseQuery>* _queryLog) { queryLog = _queryLog; }
+};
+
+// Puts the intersections appended from the given index in a canonical order: by object type, then by the map cell
+// the object was created in. The collision handling of the actors depends on the order of the candidates, while the
+// order the backends find them in depends on the backend and on the objects they hold.
+void SortIntersections(std::vector<aabb::AABBIntersection<IEntity*>>&, size_t);
+
+Broadphase* CreateBroadphase(BroadphaseType);
+const char* BroadphaseName(BroadphaseType);
+std::optional<BroadphaseType> BroadphaseTypeFromName(const std::string&);
+
+#endif
@@ -0,0 +1,53 @@
+#include <broadphase/bvh_broadphase.h>
+#include <entity.h>
+
+// Motionless terrain waits for the next BuildTerrain.
+void BVHBroadphase::InsertTerrainParticle(IEntity* particle, const aabb::Bounds2i& bounds, uint16_t categories) {
+  staticTerrain.Add(particle, bounds, categories);
+}
+
+// Rebuilds the static BVH with the terrain added since the last build, without the terrain removed meanwhile.
+void BVHBroadphase::BuildTerrain() {
+  staticTerrain.Build();
+}
+
+void BVHBroadphase::InsertParticle(IEntity* particle, const aabb::Bounds2i& bounds, uint16_t categories) {
+  dynamicObjects.insertParticle(particle, bounds, categories);
+}
+
+// Terrain that starts moving leaves the static BVH for the dynamic tree.
+bool BVHBroadphase::UpdateParticle(IEntity* particle, const aabb::Bounds2i& bounds) {
+  if (std::optional<uint16_t> categories = staticTerrain.GetCategories(particle)) {
+    staticTerrain.Remove(particle);
+    dynamicObjects.insertParticle(particle, bounds, *categories);
+    return true;
+  }
+  return dynamicObjects.updateParticle(particle, bounds);
+}
+
+void BVHBroadphase::RemoveParticle(IEntity* particle) {
+  if (!staticTerrain.Remove(particle)) {
+    dynamicObjects.removeParticle(particle);
+  }
+}
+
+void BVHBroadphase::QueryCandidates(const aabb::Bounds2i& bounds, uint16_t mask, std::vector<BroadphaseHit>& hits) {
+  staticTerrain.Query(bounds, mask, [&hits](IEntity* particle, const FatBox& box) {
+    hits.push_back({ particle, box });
+  });
+  dynamicObjects.queryLeaves(bounds, mask, [&hits](IEntity* particle, const aabb::AABB& aabb) {
+    hits.push_back({ particle, FatBox::FromAABB(aabb) });
+  });
+}
+
+std::optional<FatBox> BVHBroadphase::GetBox(IEntity* particle) {
+  if (std::optional<FatBox> box = staticTerrain.GetBox(particle)) {
+    return box;
+  }
+
+  std::optional<aabb::AABB> aabb = dynamicObjects.findAABB(particle);
+  if (!aabb.has_value()) {
+    return std::nullopt;
+  }
+  return FatBox::FromAABB(*aabb);
+}
@@ -0,0 +1,29 @@
+#ifndef BVH_BROADPHASE_H
+#define BVH_BROADPHASE_H
+
+#include <vector>
+#include <broadphase.h>
+#include <broadphase/static_bvh.h>
+#include <AABB/AABB.h>
+
+// The motionless terrain is bulk built into a static BVH, rebuilt whenever bands of the mountain are created or deleted,
+// while the objects that move (players, enemies, clouds) live in a small dynamic tree. Terrain created between builds
+// (e.g. holes filled with ice) waits in the static BVH for the next one.
+class BVHBroadphase : public Broadphase {
+  StaticBVH staticTerrain;
+  aabb::Tree<IEntity*> dynamicObjects;
+
+protected:
+  void InsertTerrainParticle(IEntity*, const aabb::Bounds2i&, uint16_t) override;
+  void InsertParticle(IEntity*, const aabb::Bounds2i&, uint16_t) override;
+  bool UpdateParticle(IEntity*, const aabb::Bounds2i&) override;
+  void RemoveParticle(IEntity*) override;
+  void QueryCandidates(const aabb::Bounds2i&, uint16_t, std::vector<BroadphaseHit>&) override;
+
+public:
+  BVHBroadphase() : staticTerrain(SKIN_THICKNESS), dynamicObjects(aabb::DIMENSION, SKIN_THICKNESS, 64) {}
+  void BuildTerrain() override;
+  std::optional<FatBox> GetBox(IEntity*) override;
+};
+
+#endif
@@ -0,0 +1,99 @@
+#include <algorithm>
+#include <broadphase/static_bvh.h>
+
+// Adds an object to the next build.
+void StaticBVH::Add(IEntity* particle, const aabb::Bounds2i& bounds, uint16_t categories) {
+  objectIndex[particle] = static_cast<uint32_t>(objects.size());
+  objects.push_back({ FatBox::Fatten(bounds, skinThickness), particle, categories });
+}
+
+// Builds the hierarchy of every added object from scratch. Removed objects are dropped.
+void StaticBVH::Build() {
+  objects.erase(std::remove_if(objects.begin(), objects.end(), [](const Object& object) { return object.particle == nullptr; }),
+                objects.end());
+
+  nodes.clear();
+  nodes.reserve(2 * (objects.size() / MAX_LEAF_OBJECTS + 1));
+  if (!objects.empty()) {
+    BuildNode(0, static_cast<uint32_t>(objects.size()));
+  }
+
+  builtObjects = static_cast<uint32_t>(objects.size());
+  objectIndex.clear();
+  objectIndex.reserve(objects.size());
+  for (uint32_t k = 0; k < objects.size(); k++) {
+    objectIndex[objects[k].particle] = k;
+  }
+}
+
+// Appends the node of the objects first..first+count and its subtree. The objects are split in two halves by the
+// median centre along the longest axis of their centres.
+uint32_t StaticBVH::BuildNode(uint32_t first, uint32_t count) {
+  uint32_t index = static_cast<uint32_t>(nodes.size());
+  nodes.push_back({});
+
+  FatBox box = objects[first].box;
+  uint32_t categories = objects[first].categories;
+  FatBox centres = { box.lowerX + box.upperX, box.lowerY + box.upperY, box.lowerX + box.upperX, box.lowerY + box.upperY };
+  for (uint32_t k = first + 1; k < first + count; k++) {
+    const FatBox& objectBox = objects[k].box;
+    box = { std::min(box.lowerX, objectBox.lowerX), std::min(box.lowerY, objectBox.lowerY),
+            std::max(box.upperX, objectBox.upperX), std::max(box.upperY, objectBox.upperY) };
+    categories |= objects[k].categories;
+
+    float centreX = objectBox.lowerX + objectBox.upperX;
+    float centreY = objectBox.lowerY + objectBox.upperY;
+    centres = { std::min(centres.lowerX, centreX), std::min(centres.lowerY, centreY),
+                std::max(centres.upperX, centreX), std::max(centres.upperY, centreY) };
+  }
+
+  if (count <= MAX_LEAF_OBJECTS) {
+    nodes[index] = { box, index + 1, first, count, categories };
+    return index;
+  }
+
+  bool splitX = (centres.upperX - centres.lowerX) >= (centres.upperY - centres.lowerY);
+  uint32_t half = count / 2;
+  std::nth_element(objects.begin() + first, objects.begin() + first + half, objects.begin() + first + count,
+                   [splitX](const Object& a, const Object& b) {
+                     return splitX ? (a.box.lowerX + a.box.upperX) < (b.box.lowerX + b.box.upperX)
+                                   : (a.box.lowerY + a.box.upperY) < (b.box.lowerY + b.box.upperY);
+                   });
+
+  BuildNode(first, half);
+  BuildNode(first + half, count - half);
+  nodes[index] = { box, static_cast<uint32_t>(nodes.size()), first, 0, categories };
+  return index;
+}
+
+// Nulls the object in its leaf. The boxes of the nodes above are left as they are (still conservative).
+bool StaticBVH::Remove(IEntity* particle) {
+  auto it = objectIndex.find(particle);
+  if (it == objectIndex.end()) {
+    return false;
+  }
+
+  objects[it->second].particle = nullptr;
+  objectIndex.erase(it);
+  return true;
+}
+
+bool StaticBVH::Contains(IEntity* particle) const {
+  return objectIndex.count(particle) != 0;
+}
+
+std::optional<FatBox> StaticBVH::GetBox(IEntity* particle) const {
+  auto it = objectIndex.find(particle);
+  if (it == objectIndex.end()) {
+    return std::nullopt;
+  }
+  return objects[it->second].box;
+}
+
+std::optional<uint16_t> StaticBVH::GetCategories(IEntity* particle) const {
+  auto it = objectIndex.find(particle);
+  if (it == objectIndex.end()) {
+    return std::nullopt;
+  }
+  return objects[it->second].categories;
+}
@@ -0,0 +1,78 @@
+#ifndef STATIC_BVH_H
+#define STATIC_BVH_H
+
+#include <vector>
+#include <unordered_map>
+#include <optional>
+#include <cstdint>
+#include <broadphase.h>
+#include <AABB/AABB.h>
+
+class IEntity;
+
+// Bounding volume hierarchy of the motionless terrain. It is bulk built in one pass and stored as a flat array of nodes
+// in depth-first order: a node is followed by its first child, and its skip index is the next node out of its subtree,
+// so queries walk the array forward without a stack. Objects added after the build wait for the next one, checked one
+// by one meanwhile; removed objects are just nulled in their leaf until the next build drops them.
+class StaticBVH {
+  struct Node {
+    FatBox box;
+    uint32_t skip;  // Next node once this subtree is rejected or visited
+    uint32_t first; // First object of a leaf
+    uint32_t count; // Objects of a leaf, 0 for inner nodes
+    uint32_t categories; // Categories of the objects of the subtree
+  };
+  struct Object { FatBox box; IEntity* particle; uint16_t categories; };
+
+  static constexpr uint32_t MAX_LEAF_OBJECTS = 4;
+
+  std::vector<Node> nodes;
+  std::vector<Object> objects;
+  uint32_t builtObjects = 0; // Objects in the leaves, the rest were added after the build
+  std::unordered_map<IEntity*, uint32_t> objectIndex;
+  double skinThickness;
+
+  uint32_t BuildNode(uint32_t, uint32_t);
+  template <class Visitor>
+  void VisitObjects(uint32_t first, uint32_t count, const aabb::Bounds2i& bounds, uint16_t mask, Visitor& visitor) const {
+    for (uint32_t k = first; k < first + count; k++) {
+      const Object& object = objects[k];
+      if (object.particle != nullptr && (object.categories & mask) != 0 && object.box.Overlaps(bounds)) {
+        visitor(object.particle, object.box);
+      }
+    }
+  }
+
+public:
+  explicit StaticBVH(double _skinThickness = 0.05) : skinThickness(_skinThickness) {}
+  void Add(IEntity*, const aabb::Bounds2i&, uint16_t);
+  void Build();
+  bool Remove(IEntity*);
+  bool Contains(IEntity*) const;
+  std::optional<FatBox> GetBox(IEntity*) const;
+  std::optional<uint16_t> GetCategories(IEntity*) const;
+  size_t Size() const { return objectIndex.size(); }
+  size_t NodeCount() const { return nodes.size(); }
+
+  // Calls the visitor with every object (and its fattened box) of the categories in the mask whose fattened box overlaps
+  // or touches the given box. The objects added since the build are checked one by one.
+  template <class Visitor>
+  void Query(const aabb::Bounds2i& bounds, uint16_t mask, Visitor&& visitor) const {
+    uint32_t i = 0;
+    uint32_t nodeCount = static_cast<uint32_t>(nodes.size());
+    while (i < nodeCount) {
+      const Node& node = nodes[i];
+      if ((node.categories & mask) == 0 || !node.box.Overlaps(bounds)) {
+        i = node.skip;
+        continue;
+      }
+
+      VisitObjects(node.first, node.count, bounds, mask, visitor);
+      i++;
+    }
+
+    VisitObjects(builtObjects, static_cast<uint32_t>(objects.size()) - builtObjects, bounds, mask, visitor);
+  }
+};
+
+#endif
@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <broadphase/sweep_and_prune_broadphase.h>
+#include <entity.h>
+
+void SweepAndPruneBroadphase::Swap(uint32_t a, uint32_t b) {
+  std::swap(entries[a], entries[b]);
+  if (entries[a].particle != nullptr) {
+    entryIndex[entries[a].particle].index = a;
+  }
+  if (entries[b].particle != nullptr) {
+    entryIndex[entries[b].particle].index = b;
+  }
+}
+
+// Leaves a tombstone in place of a sorted entry and moves the object to the unsorted entries.
+void SweepAndPruneBroadphase::Unsort(uint32_t index) {
+  Entry& entry = entries[index];
+  entryIndex[entry.particle] = { static_cast<uint32_t>(unsortedEntries.size()), false };
+  unsortedEntries.push_back(entry);
+  entry.particle = nullptr;
+  entry.categories = COLLISION_CATEGORY_NONE;
+}
+
+// Moves the last unsorted entry into the given slot. The order of the unsorted entries is irrelevant.
+void SweepAndPruneBroadphase::RemoveUnsorted(uint32_t index) {
+  unsortedEntries[index] = unsortedEntries.back();
+  unsortedEntries.pop_back();
+  if (index < unsortedEntries.size()) {
+    entryIndex[unsortedEntries[index].particle].index = index;
+  }
+}
+
+// Drops the tombstones and merges the unsorted entries that are not too wide into the sorted ones. The first call sorts
+// the objects inserted while the mountain was created, all at once.
+void SweepAndPruneBroadphase::BuildTerrain() {
+  entries.erase(std::remove_if(entries.begin(), entries.end(), [](const Entry& entry) { return entry.particle == nullptr; }),
+                entries.end());
+
+  size_t first = entries.size();
+  auto narrow = std::partition(unsortedEntries.begin(), unsortedEntries.end(),
+                               [this](const Entry& entry) { return Extent(entry.box) > MAX_SORTED_EXTENT; });
+  entries.insert(entries.end(), narrow, unsortedEntries.end());
+  unsortedEntries.erase(narrow, unsortedEntries.end());
+
+  auto lower = [this](const Entry& a, const Entry& b) { return Lower(a.box) < Lower(b.box); };
+  auto middle = entries.begin() + first;
+  std::sort(middle, entries.end(), lower);
+  std::inplace_merge(entries.begin(), middle, entries.end(), lower);
+
+  maxExtent = 0.0f;
+  for (uint32_t k = 0; k < entries.size(); k++) {
+    maxExtent = std::max(maxExtent, Extent(entries[k].box));
+    entryIndex[entries[k].particle] = { k, true };
+  }
+  for (uint32_t k = 0; k < unsortedEntries.size(); k++) {
+    entryIndex[unsortedEntries[k].particle] = { k, false };
+  }
+}
+
+void SweepAndPruneBroadphase::InsertParticle(IEntity* particle, const aabb::Bounds2i& bounds, uint16_t categories) {
+  if (entryIndex.count(particle) != 0) {
+    return;
+  }
+
+  entryIndex[particle] = { static_cast<uint32_t>(unsortedEntries.size()), false };
+  unsortedEntries.push_back({ FatBox::Fatten(bounds, SKIN_THICKNESS), particle, categories });
+}
+
+// The box is only refreshed when the object leaves its fattened box. A sorted entry is then moved to its sorted
+// position, or out of the sorted entries when it became too wide.
+bool SweepAndPruneBroadphase::UpdateParticle(IEntity* particle, const aabb::Bounds2i& bounds) {
+  auto it = entryIndex.find(particle);
+  if (it == entryIndex.end()) {
+    return false;
+  }
+
+  Location location = it->second;
+  Entry& entry = location.isSorted ? entries[location.index] : unsortedEntries[location.index];
+  if (entry.box.Contains(bounds)) {
+    return false;
+  }
+
+  entry.box = FatBox::Fatten(bounds, SKIN_THICKNESS);
+  if (!location.isSorted) {
+    return true;
+  }
+
+  uint32_t index = location.index;
+  if (Extent(entry.box) > MAX_SORTED_EXTENT) {
+    Unsort(index);
+    return true;
+  }
+
+  maxExtent = std::max(maxExtent, Extent(entry.box));
+  while (index > 0 && Lower(entries[index - 1].box) > Lower(entries[index].box)) {
+    Swap(index - 1, index);
+    index--;
+  }
+  while (index + 1 < entries.size() && Lower(entries[index + 1].box) < Lower(entries[index].box)) {
+    Swap(index, index + 1);
+    index++;
+  }
+  return true;
+}
+
+void SweepAndPruneBroadphase::RemoveParticle(IEntity* particle) {
+  auto it = entryIndex.find(particle);
+  if (it == entryIndex.end()) {
+    return;
+  }
+
+  Location location = it->second;
+  entryIndex.erase(it);
+  if (location.isSorted) {
+    entries[location.index].particle = nullptr;
+    entries[location.index].categories = COLLISION_CATEGORY_NONE;
+  } else {
+    RemoveUnsorted(location.index);
+  }
+}
+
+void SweepAndPruneBroadphase::QueryCandidates(const aabb::Bounds2i& bounds, uint16_t mask, std::vector<BroadphaseHit>& hits) {
+  // Only the entries whose lower bound lies in [lower - maxExtent, upper] can overlap along the sorting axis
+  float lower = static_cast<float>(sweepY ? bounds.lowerY : bounds.lowerX) - maxExtent - 1.0f;
+  float upper = static_cast<float>(sweepY ? bounds.upperY : bounds.upperX);
+  auto first = std::lower_bound(entries.begin(), entries.end(), lower,
+                                [this](const Entry& entry, float value) { return Lower(entry.box) < value; });
+  auto last = std::upper_bound(first, entries.end(), upper,
+                               [this](float value, const Entry& entry) { return value < Lower(entry.box); });
+
+  // Tombstones have no category, so the mask skips them
+  for (auto it = first; it != last; ++it) {
+    if ((it->categories & mask) != 0 && it->box.Overlaps(bounds)) {
+      hits.push_back({ it->particle, it->box });
+    }
+  }
+  for (auto const& entry : unsortedEntries) {
+    if ((entry.categories & mask) != 0 && entry.box.Overlaps(bounds)) {
+      hits.push_back({ entry.particle, entry.box });
+    }
+  }
+}
+
+std::optional<FatBox> SweepAndPruneBroadphase::GetBox(IEntity* particle) {
+  auto it = entryIndex.find(particle);
+  if (it == entryIndex.end()) {
+    return std::nullopt;
+  }
+  return it->second.isSorted ? entries[it->second.index].box : unsortedEntries[it->second.index].box;
+}
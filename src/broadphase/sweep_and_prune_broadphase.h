@@ -0,0 +1,48 @@
+#ifndef SWEEP_AND_PRUNE_BROADPHASE_H
+#define SWEEP_AND_PRUNE_BROADPHASE_H
+
+#include <vector>
+#include <unordered_map>
+#include <defines.h>
+#include <broadphase.h>
+#include <AABB/AABB.h>
+
+// Objects kept in an array sorted by the lower bound of their box along one axis. A query binary searches the range of
+// objects that may overlap along that axis (bounded by the widest sorted object) and checks them one by one. Moving
+// objects are kept sorted by swapping them with their neighbours. Removed objects leave a tombstone and inserted ones
+// wait in a small unsorted array until BuildTerrain, which EntityManager calls whenever bands are created or deleted,
+// merges them, so no change of the objects shifts the sorted array.
+class SweepAndPruneBroadphase : public Broadphase {
+  struct Entry { FatBox box; IEntity* particle; uint16_t categories; }; // A tombstone has no particle and no category
+  struct Location { uint32_t index; bool isSorted; };
+
+  // Objects wider than this along the sorting axis (the big cloud, the bonus stage text, the widest side walls) are
+  // never sorted, so they do not widen the range of every query.
+  static constexpr float MAX_SORTED_EXTENT = 4.0f * CELL_WIDTH;
+
+  std::vector<Entry> entries;          // Sorted by lower bound, tombstones included
+  std::vector<Entry> unsortedEntries;  // Inserted since the last BuildTerrain or too wide, checked by every query
+  std::unordered_map<IEntity*, Location> entryIndex;
+  bool sweepY;              // Sorting axis, x or y
+  float maxExtent = 0.0f;   // Largest box size of the sorted entries along the sorting axis
+
+  float Lower(const FatBox& box) const { return sweepY ? box.lowerY : box.lowerX; }
+  float Upper(const FatBox& box) const { return sweepY ? box.upperY : box.upperX; }
+  float Extent(const FatBox& box) const { return Upper(box) - Lower(box); }
+  void Swap(uint32_t, uint32_t);
+  void Unsort(uint32_t);
+  void RemoveUnsorted(uint32_t);
+
+protected:
+  void InsertParticle(IEntity*, const aabb::Bounds2i&, uint16_t) override;
+  bool UpdateParticle(IEntity*, const aabb::Bounds2i&) override;
+  void RemoveParticle(IEntity*) override;
+  void QueryCandidates(const aabb::Bounds2i&, uint16_t, std::vector<BroadphaseHit>&) override;
+
+public:
+  explicit SweepAndPruneBroadphase(bool _sweepY) : sweepY(_sweepY) {}
+  void BuildTerrain() override;
+  std::optional<FatBox> GetBox(IEntity*) override;
+};
+
+#endif
@@ -0,0 +1,28 @@
+#include <broadphase/tree_broadphase.h>
+#include <entity.h>
+
+void TreeBroadphase::InsertParticle(IEntity* particle, const aabb::Bounds2i& bounds, uint16_t categories) {
+  objects.insertParticle(particle, bounds, categories);
+}
+
+bool TreeBroadphase::UpdateParticle(IEntity* particle, const aabb::Bounds2i& bounds) {
+  return objects.updateParticle(particle, bounds);
+}
+
+void TreeBroadphase::RemoveParticle(IEntity* particle) {
+  objects.removeParticle(particle);
+}
+
+void TreeBroadphase::QueryCandidates(const aabb::Bounds2i& bounds, uint16_t mask, std::vector<BroadphaseHit>& hits) {
+  objects.queryLeaves(bounds, mask, [&hits](IEntity* particle, const aabb::AABB& aabb) {
+    hits.push_back({ particle, FatBox::FromAABB(aabb) });
+  });
+}
+
+std::optional<FatBox> TreeBroadphase::GetBox(IEntity* particle) {
+  std::optional<aabb::AABB> aabb = objects.findAABB(particle);
+  if (!aabb.has_value()) {
+    return std::nullopt;
+  }
+  return FatBox::FromAABB(*aabb);
+}
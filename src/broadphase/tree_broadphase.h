@@ -0,0 +1,23 @@
+#ifndef TREE_BROADPHASE_H
+#define TREE_BROADPHASE_H
+
+#include <vector>
+#include <broadphase.h>
+#include <AABB/AABB.h>
+
+// Every object, terrain included, in a single dynamic AABB tree filled one insertion at a time.
+class TreeBroadphase : public Broadphase {
+  aabb::Tree<IEntity*> objects;
+
+protected:
+  void InsertParticle(IEntity*, const aabb::Bounds2i&, uint16_t) override;
+  bool UpdateParticle(IEntity*, const aabb::Bounds2i&) override;
+  void RemoveParticle(IEntity*) override;
+  void QueryCandidates(const aabb::Bounds2i&, uint16_t, std::vector<BroadphaseHit>&) override;
+
+public:
+  TreeBroadphase() : objects(aabb::DIMENSION, SKIN_THICKNESS) {}
+  std::optional<FatBox> GetBox(IEntity*) override;
+};
+
+#endif
@@ -0,0 +1,64 @@
+#include <broadphase_pairs.h>
+#include <entity.h>
+
+static bool ContainsBounds(const aabb::Bounds2i& outer, const aabb::Bounds2i& inner) {
+  return inner.lowerX >= outer.lowerX && inner.upperX <= outer.upperX && inner.lowerY >= outer.lowerY && inner.upperY <= outer.upperY;
+}
+
+// Starts a new pass. The changes recorded by the broadphase from now on are the ones the pairs do not reflect.
+void BroadphasePairs::Clear() {
+  actors.clear();
+  pairs.clear();
+  broadphase->ClearChanges();
+}
+
+void BroadphasePairs::AddActor(IEntity* actor, const aabb::Bounds2i& bounds) {
+  aabb::Bounds2i sweptBounds = { bounds.lowerX - SWEEP_MARGIN, bounds.lowerY - SWEEP_MARGIN,
+                                 bounds.upperX + SWEEP_MARGIN, bounds.upperY + SWEEP_MARGIN };
+  uint32_t first = static_cast<uint32_t>(pairs.size());
+  broadphase->QueryHits(sweptBounds, pairs, actor->collisionMask);
+  actor->actorPairsIndex = static_cast<uint32_t>(actors.size());
+  actors.push_back({ actor, sweptBounds, first, static_cast<uint32_t>(pairs.size()) - first });
+}
+
+// The index stored in the actor may be left from a previous pass, or the actor may have been created since the pass.
+const BroadphasePairs::ActorPairs* BroadphasePairs::Find(IEntity* actor) const {
+  uint32_t index = actor->actorPairsIndex;
+  if (index < actors.size() && actors[index].actor == actor) {
+    return &actors[index];
+  }
+  return nullptr;
+}
+
+// Appends the intersections of the objects of the categories in the collision mask of the actor whose fattened box
+// overlaps (or touches) the given bounds of the actor. The
+// extents are computed here, as the actor usually moves between the pass and its checks. Actors created during the
+// tick, or moved beyond their swept bounds, query the broadphase directly. Either way the intersections are sorted by
+// SortIntersections.
+void BroadphasePairs::Query(IEntity* actor, const aabb::Bounds2i& bounds, std::vector<aabb::AABBIntersection<IEntity*>>& intersections) {
+  const ActorPairs* actorPairs = Find(actor);
+  if (actorPairs == nullptr || !ContainsBounds(actorPairs->sweptBounds, bounds)) {
+    fallbackCount++;
+    broadphase->Query(bounds, intersections, actor->collisionMask);
+    return;
+  }
+
+  size_t first = intersections.size();
+  const std::vector<IEntity*>& changedParticles = broadphase->ChangedParticles();
+  for (uint32_t k = actorPairs->first; k < actorPairs->first + actorPairs->count; k++) {
+    const BroadphaseHit& hit = pairs[k];
+    if (hit.box.Overlaps(bounds) && !broadphase->HasChanged(hit.particle)) {
+      intersections.push_back(hit.box.Intersection(hit.particle, bounds));
+    }
+  }
+
+  for (IEntity* particle : changedParticles) {
+    if ((particle->collisionCategory & actor->collisionMask) == 0) continue;
+
+    std::optional<FatBox> box = broadphase->GetBox(particle);
+    if (box.has_value() && box->Overlaps(bounds)) {
+      intersections.push_back(box->Intersection(particle, bounds));
+    }
+  }
+  SortIntersections(intersections, first);
+}
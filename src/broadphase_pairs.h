@@ -0,0 +1,36 @@
+#ifndef BROADPHASE_PAIRS_H
+#define BROADPHASE_PAIRS_H
+
+#include <vector>
+#include <cstdint>
+#include <broadphase.h>
+#include <AABB/AABB.h>
+
+class IEntity;
+
+// Candidate pairs of the tick. Every actor (player and enemies) queries the broadphase once, at the start of the tick,
+// with its bounds grown by a margin that covers its movement during the tick and its collision mask. The narrowphase checks of the actor then
+// filter its candidates instead of traversing the broadphase again. The boxes of the objects inserted, moved or removed
+// since the pass are fetched again from the broadphase, so the result matches a direct query.
+class BroadphasePairs {
+  struct ActorPairs { IEntity* actor; aabb::Bounds2i sweptBounds; uint32_t first; uint32_t count; };
+
+  Broadphase* broadphase;
+  std::vector<ActorPairs> actors;
+  std::vector<BroadphaseHit> pairs; // Candidates of every actor, contiguous per actor
+  uint64_t fallbackCount = 0;       // Checks not covered by the swept bounds of the actor
+
+  const ActorPairs* Find(IEntity*) const;
+
+public:
+  static constexpr int SWEEP_MARGIN = 16; // pixels
+
+  explicit BroadphasePairs(Broadphase* _broadphase) : broadphase(_broadphase) {}
+  void Clear();
+  void AddActor(IEntity*, const aabb::Bounds2i&);
+  void Query(IEntity*, const aabb::Bounds2i&, std::vector<aabb::AABBIntersection<IEntity*>>&);
+  size_t PairCount() const { return pairs.size(); }
+  uint64_t FallbackCount() const { return fallbackCount; }
+};
+
+#endif
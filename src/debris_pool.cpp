@@ -0,0 +1,109 @@
+#include <cmath>
+#include <debris_pool.h>
+
+// Adds a piece at the given position. vSpeed is positive upwards and hSpeed positive to the right. The piece shows
+// source until nextFrameTick, then goes on with the given frame of the animation.
+void DebrisPool::Spawn(const AnimationTable& table, uint32_t animation, uint32_t frame, uint64_t nextFrameTick,
+                       Rectangle source, Boundaries boundingBox, float _x, float _y, float _vSpeed, float _hSpeed) {
+  animationTable = &table;
+  x.push_back(_x);
+  y.push_back(_y);
+  previousX.push_back(_x);
+  previousY.push_back(_y);
+  initialX.push_back(_x);
+  initialY.push_back(_y);
+  hSpeed.push_back(_hSpeed);
+  vSpeed.push_back(_vSpeed);
+  t.push_back(0.0f);
+  animations.push_back(animation);
+  frames.push_back(frame);
+  nextFrameTicks.push_back(nextFrameTick);
+  sources.push_back(source);
+  boundingBoxes.push_back(boundingBox);
+}
+
+// Moves the last piece into the given slot. The order of the pieces is irrelevant.
+void DebrisPool::SwapRemove(size_t k) {
+  size_t last = t.size() - 1;
+  x[k] = x[last]; x.pop_back();
+  y[k] = y[last]; y.pop_back();
+  previousX[k] = previousX[last]; previousX.pop_back();
+  previousY[k] = previousY[last]; previousY.pop_back();
+  initialX[k] = initialX[last]; initialX.pop_back();
+  initialY[k] = initialY[last]; initialY.pop_back();
+  hSpeed[k] = hSpeed[last]; hSpeed.pop_back();
+  vSpeed[k] = vSpeed[last]; vSpeed.pop_back();
+  t[k] = t[last]; t.pop_back();
+  animations[k] = animations[last]; animations.pop_back();
+  frames[k] = frames[last]; frames.pop_back();
+  nextFrameTicks[k] = nextFrameTicks[last]; nextFrameTicks.pop_back();
+  sources[k] = sources[last]; sources.pop_back();
+  boundingBoxes[k] = boundingBoxes[last]; boundingBoxes.pop_back();
+}
+
+// Shows the next frame of the animation of the piece, starting over after the last one.
+void DebrisPool::LoadNextFrame(size_t k, uint64_t tick) {
+  if (frames[k] == animationTable->GetSpriteCount(animations[k])) {
+    frames[k] = 0;
+  }
+
+  SpriteData spriteData = animationTable->GetSprite(animations[k], frames[k]++);
+  sources[k] = { spriteData.u1, spriteData.v1, spriteData.u2, spriteData.v2 };
+  boundingBoxes[k] = { spriteData.lowerBoundX, spriteData.lowerBoundY, spriteData.upperBoundX, spriteData.upperBoundY };
+  nextFrameTicks[k] = tick + spriteData.durationTicks;
+}
+
+void DebrisPool::Update(uint64_t tick) {
+  // Pieces that finished their trajectory during the previous tick have already been drawn at their last position
+  for (size_t k = 0; k < t.size();) {
+    if (t[k] >= LIFETIME) {
+      SwapRemove(k);
+    } else {
+      if (tick >= nextFrameTicks[k]) {
+        LoadNextFrame(k, tick);
+      }
+      k++;
+    }
+  }
+
+  size_t count = t.size();
+  float* px = x.data();
+  float* py = y.data();
+  float* ppx = previousX.data();
+  float* ppy = previousY.data();
+  const float* x0 = initialX.data();
+  const float* y0 = initialY.data();
+  const float* hs = hSpeed.data();
+  const float* vs = vSpeed.data();
+  float* pt = t.data();
+
+  // Equation of vertical and horizontal displacement of a parabolic jump
+  for (size_t k = 0; k < count; k++) {
+    ppx[k] = px[k];
+    ppy[k] = py[k];
+    float tk = pt[k] + TIME_STEP;
+    pt[k] = tk;
+    float vOffset = -(vs[k] * tk - (0.5f) * GRAVITY * tk * tk);
+    px[k] = x0[k] + (hs[k] * tk);
+    py[k] = y0[k] + vOffset;
+  }
+}
+
+// Appends the pieces inside the vertical band [bandTop, bandBottom] to the frame, up to maxLength sprites.
+void DebrisPool::PushSpriteRects(SpriteRectFrame& frame, uint32_t& i, uint32_t maxLength, float bandTop, float bandBottom) const {
+  for (size_t k = 0; k < t.size() && i < maxLength; k++) {
+    if (y[k] + std::abs(sources[k].height) < bandTop || y[k] > bandBottom) continue;
+
+    Vector2 pos = { x[k], y[k] };
+    Vector2 prevPos = { previousX[k], previousY[k] };
+    if (std::abs(x[k] - previousX[k]) > INTERPOLATION_SNAP_DISTANCE || std::abs(y[k] - previousY[k]) > INTERPOLATION_SNAP_DISTANCE) {
+      prevPos = pos;
+    }
+
+    int intX = static_cast<int>(x[k]);
+    int intY = static_cast<int>(y[k]);
+    Boundaries boundaries = { intX + boundingBoxes[k].upperBoundX, intY + boundingBoxes[k].upperBoundY,
+                              intX + boundingBoxes[k].lowerBoundX, intY + boundingBoxes[k].lowerBoundY };
+    frame.sprites[i++] = SpriteRect(sources[k], pos, prevPos, boundaries, WHITE);
+  }
+}
@@ -0,0 +1,43 @@
+#ifndef DEBRIS_POOL_H
+#define DEBRIS_POOL_H
+
+#include <vector>
+#include <cstdint>
+#include <sprite_rect_triple_buffer.h>
+#include <entity_sprite_sheet_animation.h>
+
+// Pieces of the broken bricks flying away along a parabola. The brick entity is released as soon as it breaks and its
+// animation is handed over to the pool, which keeps the state of every piece in parallel arrays so all of them are
+// integrated by a single loop the compiler can vectorize.
+class DebrisPool {
+  // Trajectory, one entry per piece
+  std::vector<float> x, y;
+  std::vector<float> previousX, previousY; // Position at the previous tick, published for render interpolation
+  std::vector<float> initialX, initialY;
+  std::vector<float> hSpeed, vSpeed;
+  std::vector<float> t;
+
+  // Falling animation, advanced as IEntity::LoadNextSprite does
+  const AnimationTable* animationTable = nullptr; // The animations of every sprite sheet live in the same table
+  std::vector<uint32_t> animations;
+  std::vector<uint32_t> frames;                    // Next frame to load, as IEntity::currentAnimationFrame
+  std::vector<uint64_t> nextFrameTicks;
+
+  // Drawing data of the current frame, only read when the frame is published
+  std::vector<Rectangle> sources;
+  std::vector<Boundaries> boundingBoxes; // Relative to the position, as IEntity::boundingBox
+
+  void SwapRemove(size_t);
+  void LoadNextFrame(size_t, uint64_t);
+
+public:
+  static constexpr float TIME_STEP = 0.2f;      // Parabola time advanced every tick
+  static constexpr float LIFETIME = 30.0f;      // Parabola time after which a piece is discarded (out of the screen)
+
+  void Spawn(const AnimationTable&, uint32_t, uint32_t, uint64_t, Rectangle, Boundaries, float, float, float, float);
+  void Update(uint64_t);
+  void PushSpriteRects(SpriteRectFrame&, uint32_t&, uint32_t, float, float) const;
+  size_t Size() const { return t.size(); }
+};
+
+#endif
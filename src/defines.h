@@ -64,6 +64,8 @@ enum BonusStageTextAnimation: uint16_t { BONUS_STAGE_TEXT_STICKY = 70 };
 
 // Others
 constexpr const char* ENTITY_TYPES_FILENAME = "objtypes.dat";              // Data file where entity animations and collision areas are defined.
+constexpr const char* ENTITY_TYPES_CACHE_FILENAME = "objtypes.bin";       // Binary cache of the entity types file, rebuilt when the data file changes.
+constexpr const char* MOUNTAIN_FILENAME = "levels/mountain01.map";        // Map of the mountain, compiled into a .bin file next to it.
 constexpr float GRAVITY = 9.81f;                                           // Gravity value used for physics calculations.
 constexpr int MIN_PIXELS_ON_UNDERLYING_SURFACE = 4;                        // Min number of pixels on the edge of an underlying surface to do not fall.
 constexpr int SLIPPING_DISTANCE = 30;                                      // The distance, in pixels, the player slips when suddenly stopping on an ice floor.
@@ -75,8 +77,16 @@ constexpr int LEVEL_WIDTH_CELLS = 32;                                      // Th
 constexpr int LEVEL_WIDTH = LEVEL_WIDTH_CELLS * CELL_WIDTH;                // The integer width in pixels of a level. 32cells x 16px
 constexpr float LEVEL_WIDTH_FLOAT = LEVEL_WIDTH_CELLS * CELL_WIDTH_FLOAT;  // The float width in pixels of a level. 32cells x 16px
 constexpr float TOPI_LEVEL_RIGHT_EDGE_MARGIN = 5.0f;
+constexpr int VIEWPORT_HEIGHT_CELLS = 30;                                  // Number of rows shown on screen.
+constexpr int CULLING_MARGIN_ROWS = 6;                                     // Rows above and below the viewport still sent to the render thread.
+constexpr int TERRAIN_CHUNK_ROWS = 6;                                      // Rows of static terrain cached together by the render thread (one level).
+constexpr int STREAMED_BANDS_AHEAD = 1;                                    // Bands of the map created above the rows sent to the render thread.
+constexpr int MAX_VISIBLE_TERRAIN_CHUNKS = (VIEWPORT_HEIGHT_CELLS + 2 * CULLING_MARGIN_ROWS) / TERRAIN_CHUNK_ROWS + 2;
 constexpr float INITIAL_CAMERA_POSITION = 156 * CELL_HEIGHT_FLOAT;         // Initial camera vertical position when player is at level 1
 constexpr int BONUS_STAGE_CELL_Y = 128;                                    // Vertical cell position where bonus stage starts
 constexpr float CAMERA_PADDING_TOP = 13 * CELL_HEIGHT_FLOAT;               // Camera viewport top padding space
 constexpr float CAMERA_BONUS_STAGE_PADDING_TOP = 19 * CELL_HEIGHT_FLOAT;   // Camera viewport top padding space in the bonus stage
-constexpr float CAMERA_SPEED = 3.0f;                                       // Camera speed in vertical píxels per tick
\ No newline at end of file
+constexpr float CAMERA_SPEED = 3.0f;                                       // Camera speed in vertical píxels per tick
+constexpr int TICKS_PER_SECOND = 60;                                       // Fixed game logic rate, independent of the display refresh rate.
+constexpr int MAX_CATCH_UP_TICKS = 5;                                      // Max ticks run back to back to recover from a stall before dropping time.
+constexpr float INTERPOLATION_SNAP_DISTANCE = LEVEL_WIDTH_FLOAT / 2;       // Per-tick displacement treated as a teleport (e.g. screen wrap) and not interpolated.
\ No newline at end of file
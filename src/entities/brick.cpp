@@ -1,82 +1,56 @@
 #include <entities/brick.h>
-#include <chrono>
+#include <entity_manager.h>
 
 Brick::Brick() :
         IEntity(EntityIdentificator::BRICK, EntityType::TERRAIN, SurfaceType::SIMPLE, BrickStateIdentificator::BRICK_MAX_STATES, true, false) {
+        updatesEveryTick = false; // Only animated, woken up by the animation scheduler
 }
 
 Brick::Brick(EntityIdentificator _id, EntityType _type, SurfaceType surface_type, unsigned char max_states, bool is_breakable, bool is_traversable) :
         IEntity(_id, _type, surface_type, max_states, is_breakable, is_traversable) {
+        updatesEveryTick = false;
 }
 
 void Brick::PrintName() {
         std::cout << "Brick." << std::endl;
 }
 
-void Brick::Propel(float vSpeed, float hSpeed) {
-    vInitialPropelSpeed = vSpeed;
-    hInitialPropelSpeed = hSpeed;
-    vInitialPropelPosition = position.GetRealY();
-    hInitialPropelPosition = position.GetRealX();
-    tPropel = 0.0f;
-    isPropelled = true;
-}
-
 bool Brick::Update(uint8_t pressedKeys_) {
         if (isMarkedToDelete) {
                 return false;
         }
 
-        bool needRedraw = false;
-
         if(!animationLoaded) {
                 return false;
         }
 
-        if (isPropelled) {
-                UpdatePropel();
-                needRedraw = true;
-        }
-        else if(animationHasOnlyOneSprite && firstSpriteOfCurrentAnimationIsLoaded) {
+        if(animationHasOnlyOneSprite && firstSpriteOfCurrentAnimationIsLoaded) {
                 return false;
         }
 
-        if(chrono::system_clock::now() >= nextSpriteTime) {
+        if(NextSpriteIsDue()) {
                 // Load next sprite of the current animation
                 LoadNextSprite();
                 return true;
         }
 
-        return needRedraw;
-}
-
-void Brick::UpdatePropel() {
-    tPropel += 0.2f;
-
-    // Equation of vertical and horizontal displacement of a parabolic jump.
-    float vOffset = -(vInitialPropelSpeed * tPropel - (0.5f) * GRAVITY * tPropel * tPropel);
-
-    // Update vertical propel position
-    PositionSetXY(hInitialPropelPosition + (hInitialPropelSpeed * tPropel), vInitialPropelPosition + vOffset);
-
-    if (tPropel >= 30.0f) {
-        FinishPropel();
-    }
-}
-
-void Brick::FinishPropel() {
-    isPropelled = false;
-    isMarkedToDelete = true;
+        return false;
 }
 
 void Brick::Hit(bool propelToRight) {
-        if (!isBreakable) {
+        if (!isBreakable || isMarkedToDelete) {
                 return;
         }
 
         RemoveFromSpacePartitionObjectsTree();
+        entityManager->RemoveFromTerrainCache(this);
+        entityManager->RemoveFromTerrainGrid(this);
         Break();
-        Propel(24.0f, propelToRight ? 10.0f : -10.0f);
+        LoadNextSprite(); // First sprite of the falling animation
+
+        // The debris pool draws the falling brick and the rest of its animation from now on
+        entityManager->SpawnDebris(this, spriteSheet->GetAnimationTable(), currentAnimation, currentAnimationFrame, nextSpriteTick,
+                                   24.0f, propelToRight ? 10.0f : -10.0f);
 }
 
 void Brick::InitWithSpriteSheet(EntitySpriteSheet *_spriteSheet) {
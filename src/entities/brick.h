@@ -13,19 +13,6 @@ using namespace std;
 
 class Brick: public IEntity
 {
-  bool isPropelled = false;
-  void Propel(float vSpeed, float hSpeed);
-  void UpdatePropel();
-  void FinishPropel();
-
-  // Propel trajectory data
-  float hInitialPropelSpeed = 0.0f;
-  float vInitialPropelSpeed = 0.0f;
-  float tPropel = 0.0f;
-  float hInitialPropelPosition = 0.0f;
-  float vInitialPropelPosition = 0.0f;
-  float previous_vOffset = 0.0f;
-
 public:
   Brick(EntityIdentificator, EntityType, SurfaceType, unsigned char, bool, bool);
   Brick();
@@ -1,35 +1,49 @@
 #include <entities/cloud.h>
-#include <chrono>
+#include <entity_manager.h>
 
 Cloud::Cloud() :
         IEntity(EntityIdentificator::CLOUD_SMALL, EntityType::TERRAIN, SurfaceType::SIMPLE, CloudStateIdentificator::CLOUD_MAX_STATES, false, false) {
+        collisionCategory = COLLISION_CATEGORY_CLOUD;
 }
 
 Cloud::Cloud(EntityIdentificator _id, EntityType _type, SurfaceType surface_type, unsigned char max_states, bool is_breakable, bool is_traversable) :
         IEntity(_id, _type, surface_type, max_states, is_breakable, is_traversable) {
+        collisionCategory = COLLISION_CATEGORY_CLOUD;
 }
 
 void Cloud::PrintName() {
         std::cout << "Cloud." << std::endl;
 }
 
-bool Cloud::IsCloud() {
-  return true;
+// Horizontal position of the cloud at the given tick. Clouds fly one pixel per tick and respawn on the opposite margin
+// once they disappear, so the position is periodic: flying right it runs from -width to LEVEL_WIDTH - 1, flying left
+// from LEVEL_WIDTH down to -width + 1.
+float Cloud::FlightX(uint64_t tick) {
+        int64_t width = Width();
+        int64_t period = LEVEL_WIDTH + width;
+        int64_t elapsed = static_cast<int64_t>(tick - *flightStartTick);
+        int64_t startX = static_cast<int64_t>(flightStartX);
+
+        if (flyToRight) {
+                return static_cast<float>(-width + (startX + width + elapsed) % period);
+        }
+        return static_cast<float>(LEVEL_WIDTH - (LEVEL_WIDTH - startX + elapsed) % period);
 }
 
 void Cloud::UpdateFlight() {
-        PositionAddX(flyToRight ? 1.0f : -1.0f);
-
-        // Respawn the cloud when it disappears from the margins
-        if (flyToRight && (position.GetIntX() >= LEVEL_WIDTH)) {
-                PositionSetX(0.0f - static_cast<float>(Width()));
-        }
-        else if (!flyToRight && (position.GetIntX() <= 0.0f - static_cast<float>(Width()))) {
-                PositionSetX(static_cast<float>(LEVEL_WIDTH));
+        uint64_t tick = entityManager->GetTick();
+        if (!flightStartTick.has_value()) {
+                flightStartTick = tick - 1;
+                flightStartX = position.GetRealX();
         }
 
-        // Update the position of the cloud in the space partition tree
-        UpdatePositionInSpacePartitionTree();
+        PositionSetX(FlightX(tick));
+
+        // The broadphase keeps the fattened box of the cloud until the cloud leaves it, so it is only updated then
+        if (!broadphaseBox.has_value() || !broadphaseBox->Contains(GetBounds())) {
+                UpdatePositionInSpacePartitionTree();
+                broadphaseBox = broadphase->GetBox(this);
+        }
 }
 
 bool Cloud::Update(uint8_t pressedKeys_) {
@@ -49,7 +63,7 @@ bool Cloud::Update(uint8_t pressedKeys_) {
                 return false;
         }
 
-        if(chrono::system_clock::now() >= nextSpriteTime) {
+        if(NextSpriteIsDue()) {
                 // Load next sprite of the current animation
                 LoadNextSprite();
                 return true;
@@ -3,6 +3,7 @@
 
 #include <iostream>
 #include <vector>
+#include <optional>
 #include <entity.h>
 #include <state_machine.h>
 #include <sprite.h>
@@ -15,14 +16,17 @@ class Cloud: public IEntity
 {
 protected:
   void UpdateFlight();
+  float FlightX(uint64_t);
   bool flyToRight = true;
+  std::optional<uint64_t> flightStartTick; // Tick before the first flight step, when the cloud was at flightStartX
+  float flightStartX = 0.0f;
+  std::optional<FatBox> broadphaseBox; // Box of the cloud in the broadphase, refreshed once the cloud leaves it
 public:
   Cloud(EntityIdentificator, EntityType, SurfaceType, unsigned char, bool, bool);
   Cloud();
   ~Cloud();
   virtual void InitWithSpriteSheet(EntitySpriteSheet*);
   virtual void PrintName();
-  bool IsCloud() override;
   bool Update(uint8_t);
   static IEntity* Create();
 
@@ -1,11 +1,11 @@
 #include <entities/ice.h>
-#include <chrono>
 
 Ice::Ice() :
         IEntity(EntityIdentificator::ICE, EntityType::ENEMY, SurfaceType::SIMPLE, IceStateIdentificator::ICE_MAX_STATES, false, true) {
     vectorDirection.x = 0;
     vectorDirection.y = 0;
     fillHoleEntityId = std::nullopt;
+    collisionCategory = COLLISION_CATEGORY_ICE;
 }
 
 void Ice::PrintName() {
@@ -21,7 +21,7 @@ bool Ice::Update(const uint8_t pressedKeys_) {
 
     // Delete the block of ice if reached screen edges
     if (firstSpriteOfCurrentAnimationIsLoaded && ReachedScreenEdge()) {
-        isMarkedToDelete = true;
+        entityManager->Despawn(this);
     }
 
     // Check for collisions
@@ -35,7 +35,7 @@ bool Ice::Update(const uint8_t pressedKeys_) {
         return false;
     }
 
-    if (chrono::system_clock::now() >= nextSpriteTime) {
+    if (NextSpriteIsDue()) {
         // Load next sprite of the current animation
         LoadNextSprite();
 
@@ -50,7 +50,8 @@ bool Ice::Update(const uint8_t pressedKeys_) {
 
 void Ice::GetSolidCollisions(std::vector<ObjectCollision> &collisions, bool& iceIsSuspendedInTheAir, bool& iceFoundAHoleOnTheFloor) {
     // Check for collisions with other objects present in the scene.
-    std::vector<aabb::AABBIntersection<IEntity*>> objectIntersections = spacePartitionObjectsTree->query(GetLowerBound(), GetUpperBound());
+    objectIntersections.clear();
+    entityManager->QueryCollisions(this, GetBounds(), objectIntersections);
     iceIsSuspendedInTheAir = false;
     iceFoundAHoleOnTheFloor = false;
     IEntity* underlyingObjectCandidate = nullptr;
@@ -120,7 +121,7 @@ void Ice::GetSolidCollisions(std::vector<ObjectCollision> &collisions, bool& ice
 }
 
 void Ice::UpdateCollisions() {
-    std::vector<ObjectCollision> collisions;
+    collisions.clear();
     bool iceIsSuspendedInTheAir = false;
     bool iceFoundAHoleOnTheFloor = false;
 
@@ -140,27 +141,12 @@ void Ice::UpdateCollisions() {
                 }
 
                 int cell_y = position.GetCellY() + (Height() / CELL_HEIGHT);
-                int x = cell_x * CELL_WIDTH;
-                int y = cell_y * CELL_HEIGHT;
-                std::vector<int> lowerBound{x + 1, y + 1};
-                std::vector<int> upperBound{x + CELL_WIDTH - 1, y + CELL_HEIGHT - 2};
-
-                std::vector<aabb::AABBIntersection<IEntity*>> objectIntersections = spacePartitionObjectsTree->query(lowerBound, upperBound);
-                bool object_collides = false;
-
-                for (auto intersection : objectIntersections) {
-                    if (!intersection.particle->isTraversable && !intersection.particle->isMarkedToDelete && !intersection.particle->IsCloud() && !intersection.particle->IsTopi()) {
-                        object_collides = true;
-                        break;
-                    }
-                }
-
-                if (!object_collides) {
-                    entityManager->CreateEntityWithId(*fillHoleEntityId, cell_x, cell_y);
+                if (!entityManager->GetTerrainGrid().IsSolid(cell_x, cell_y)) {
+                    entityManager->Spawn(*fillHoleEntityId, cell_x, cell_y, true);
                 }
             }
         }
-        isMarkedToDelete = true;
+        entityManager->Despawn(this);
         return;
     }
 
@@ -20,6 +20,8 @@ class Ice: public IEntity
 {
   Direction direction;
   void GetSolidCollisions(std::vector<ObjectCollision>&, bool&, bool&);
+  std::vector<aabb::AABBIntersection<IEntity*>> objectIntersections; // Reused query buffers, so collision checks do not allocate
+  std::vector<ObjectCollision> collisions;
 
   std::optional<EntityIdentificator> fillHoleEntityId;
   IEntity* currentUnderlyingObject = nullptr;
@@ -1,5 +1,4 @@
 #include <entities/player.h>
-#include <chrono>
 
 Player::Player() :
         IEntity(EntityIdentificator::POPO, EntityType::PLAYER, SurfaceType::SIMPLE, PlayerStateIdentificator::POPO_MAX_STATES, false, true) {
@@ -8,12 +7,18 @@ Player::Player() :
     prevVectorDirection.x = 0;
     prevVectorDirection.y = 0;
     underlyingObjectSurfaceType = SurfaceType::SIMPLE;
+    collisionCategory = COLLISION_CATEGORY_PLAYER;
+    collisionMask = COLLISION_CATEGORY_SOLID | COLLISION_CATEGORY_CLOUD; // Traversable objects are not reported
 }
 
 void Player::PrintName() {
     std::cout << "Main character." << std::endl;
 }
 
+bool Player::IsIgnoredDuringFall(IEntity* object) {
+    return std::find(objectsToIgnoreDuringFall.begin(), objectsToIgnoreDuringFall.end(), object->handle) != objectsToIgnoreDuringFall.end();
+}
+
 void Player::DisplacePlayerIfUnderlyingSurfaceIsMobile() {
     if (!underlyingObjectSurfaceType.has_value()) {
         return;
@@ -103,7 +108,7 @@ bool Player::Update(const uint8_t pressedKeys_) {
         return false;
     }
 
-    if (chrono::system_clock::now() >= nextSpriteTime) {
+    if (NextSpriteIsDue()) {
         // Load next sprite of the current animation
         LoadNextSprite();
 
@@ -118,7 +123,8 @@ bool Player::Update(const uint8_t pressedKeys_) {
 
 void Player::GetSolidCollisions(std::vector<ObjectCollision> &collisions, bool& playerIsSuspendedInTheAir) {
     // Check for collisions with other objects present in the scene.
-    std::vector<aabb::AABBIntersection<IEntity*>> objectIntersections = spacePartitionObjectsTree->query(GetSolidLowerBound(), GetSolidUpperBound());
+    objectIntersections.clear();
+    entityManager->QueryCollisions(this, GetSolidBounds(), objectIntersections);
     playerIsSuspendedInTheAir = true;
     IEntity* underlyingObjectCandidate = nullptr;
     prevUnderlyingCloud = currentUnderlyingCloud;
@@ -127,7 +133,7 @@ void Player::GetSolidCollisions(std::vector<ObjectCollision> &collisions, bool&
     int minIntersectionXDiffUnderlyingObjectCandidate = 9999;
 
     for (auto intersection : objectIntersections) {
-        if ((intersection.particle == this) || intersection.particle->isTraversable || (std::find(objectsToIgnoreDuringFall.begin(), objectsToIgnoreDuringFall.end(), intersection.particle) != objectsToIgnoreDuringFall.end())) {
+        if (IsIgnoredDuringFall(intersection.particle)) {
             continue;
         }
 
@@ -249,7 +255,7 @@ void Player::GetSolidCollisions(std::vector<ObjectCollision> &collisions, bool&
 }
 
 void Player::UpdateCollisions() {
-    std::vector<ObjectCollision> collisions;
+    collisions.clear();
     bool playerIsSuspendedInTheAir = false;
 
     // Search for collisions with solid objects
@@ -542,7 +548,7 @@ void Player::LoadNextSprite() {
         }
     }
 
-    nextSpriteTime = (chrono::system_clock::now() + chrono::milliseconds(spriteData.duration));
+    ScheduleNextSprite(spriteData.durationTicks);
 
     currentSprite.width = spriteData.width;
     currentSprite.height = spriteData.height;
@@ -552,6 +558,7 @@ void Player::LoadNextSprite() {
     currentSprite.v1 = spriteData.v1;
     currentSprite.u2 = spriteData.u2;
     currentSprite.v2 = spriteData.v2;
+    currentSprite.areas = spriteData.areas;
 
     // Adjusts object position according to the sprite offset
     PositionSetOffset(spriteData.xOffset, spriteData.yOffset);
@@ -625,8 +632,8 @@ void Player::FallDueToLateralCollisionJump() {
 
 void Player::FallDueToSuspendedInTheAir() {
     // Ignore collisions with the previous underlying cloud when player falls.
-    if (prevUnderlyingCloud != nullptr && (std::find(objectsToIgnoreDuringFall.begin(), objectsToIgnoreDuringFall.end(), prevUnderlyingCloud) == objectsToIgnoreDuringFall.end())) {
-        objectsToIgnoreDuringFall.push_back(prevUnderlyingCloud);
+    if (prevUnderlyingCloud != nullptr && !IsIgnoredDuringFall(prevUnderlyingCloud)) {
+        objectsToIgnoreDuringFall.push_back(prevUnderlyingCloud->handle);
     }
 
     hMomentum = 0;
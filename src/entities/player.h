@@ -27,6 +27,8 @@ class Player: public IEntity
   bool PlayerIsQuiet();
   void UpdatePreviousDirection();
   void GetSolidCollisions(std::vector<ObjectCollision>&, bool&);
+  std::vector<aabb::AABBIntersection<IEntity*>> objectIntersections; // Reused query buffers, so collision checks do not allocate
+  std::vector<ObjectCollision> collisions;
   void DisplacePlayerIfUnderlyingSurfaceIsMobile();
   void CorrectPlayerPositionOnReachScreenEdge();
 
@@ -55,7 +57,8 @@ class Player: public IEntity
   std::optional<SurfaceType> underlyingObjectSurfaceType;
   IEntity* prevUnderlyingCloud = nullptr;
   IEntity* currentUnderlyingCloud = nullptr;
-  std::vector<IEntity*> objectsToIgnoreDuringFall;
+  std::vector<EntityHandle> objectsToIgnoreDuringFall; // Handles do not dangle if the objects are deleted meanwhile
+  bool IsIgnoredDuringFall(IEntity*);
 
   // Player action states
   bool isRunning = false;          // Player is running on a floor
@@ -1,12 +1,13 @@
 #include <entities/side_wall.h>
-#include <chrono>
 
 SideWall::SideWall() :
         IEntity(EntityIdentificator::SIDE_WALL, EntityType::TERRAIN, SurfaceType::SIMPLE, SideWallStateIdentificator::SIDE_WALL_MAX_STATES, false, true) {
+        updatesEveryTick = false; // Only animated, woken up by the animation scheduler
 }
 
 SideWall::SideWall(EntityIdentificator _id, EntityType _type, SurfaceType surface_type, unsigned char max_states, bool is_breakable, bool is_traversable) :
         IEntity(_id, _type, surface_type, max_states, is_breakable, is_traversable) {
+        updatesEveryTick = false;
 }
 
 void SideWall::PrintName() {
@@ -24,7 +25,7 @@ bool SideWall::Update(uint8_t pressedKeys_) {
                 return false;
         }
 
-        if(chrono::system_clock::now() >= nextSpriteTime) {
+        if(NextSpriteIsDue()) {
                 // Load next sprite of the current animation
                 LoadNextSprite();
                 return true;
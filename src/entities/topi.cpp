@@ -1,19 +1,20 @@
 #include <entities/topi.h>
-#include <chrono>
 
 Topi::Topi() :
         IEntity(EntityIdentificator::TOPI, EntityType::ENEMY, SurfaceType::SIMPLE, TopiStateIdentificator::TOPI_MAX_STATES, false, true) {
     vectorDirection.x = 0;
     vectorDirection.y = 0;
     objectToCarryId = std::nullopt;
+    collisionCategory = COLLISION_CATEGORY_TOPI;
+    collisionMask = COLLISION_CATEGORY_SOLID | COLLISION_CATEGORY_CLOUD; // Traversable objects are not reported
 }
 
 void Topi::PrintName() {
     std::cout << "Topi." << std::endl;
 }
 
-bool Topi::IsTopi() {
-  return true;
+bool Topi::IsIgnoredDuringFall(IEntity* object) {
+  return std::find(objectsToIgnoreDuringFall.begin(), objectsToIgnoreDuringFall.end(), object->handle) != objectsToIgnoreDuringFall.end();
 }
 
 inline bool Topi::ReachedScreenEdge() {
@@ -74,7 +75,7 @@ bool Topi::Update(const uint8_t pressedKeys_) {
         return false;
     }
 
-    if (chrono::system_clock::now() >= nextSpriteTime) {
+    if (NextSpriteIsDue()) {
         // Load next sprite of the current animation
         LoadNextSprite();
 
@@ -89,7 +90,8 @@ bool Topi::Update(const uint8_t pressedKeys_) {
 
 void Topi::GetSolidCollisions(std::vector<ObjectCollision> &collisions, bool& topiIsSuspendedInTheAir, bool& topiFoundAHoleOnTheFloor) {
     // Check for collisions with other objects present in the scene.
-    std::vector<aabb::AABBIntersection<IEntity*>> objectIntersections = spacePartitionObjectsTree->query(GetLowerBound(), GetUpperBound());
+    objectIntersections.clear();
+    entityManager->QueryCollisions(this, GetBounds(), objectIntersections);
     topiIsSuspendedInTheAir = false;
     topiFoundAHoleOnTheFloor = false;
     IEntity* underlyingObjectCandidate = nullptr;
@@ -99,7 +101,7 @@ void Topi::GetSolidCollisions(std::vector<ObjectCollision> &collisions, bool& to
     int numPixelsUnderlyingObjectsSurface = 0;
 
     for (auto intersection : objectIntersections) {
-        if ((intersection.particle == this) || intersection.particle->isTraversable || (std::find(objectsToIgnoreDuringFall.begin(), objectsToIgnoreDuringFall.end(), intersection.particle) != objectsToIgnoreDuringFall.end())) {
+        if (IsIgnoredDuringFall(intersection.particle)) {
             continue;
         }
 
@@ -173,10 +175,12 @@ void Topi::GetSolidCollisions(std::vector<ObjectCollision> &collisions, bool& to
     }
 
     cout << "\n >>>>>>> TOPI UNDERLYING SURFACE: " << numPixelsUnderlyingObjectsSurface << " currentSprite.width: " << currentSprite.width << "\n";
-    // Check if a hole is present on the ground based on an heuristic way.
-    // If the number of pixels of the underlying surface is 3 pixels (or more) lower than the width of
-    // the Topi then there is a hole under Topi. Note that screen edges are not taken in consideration.
-    if ((underlyingObjectCandidate != nullptr) && !((position.GetRealX() < 0.0f) || (position.GetRealX() >= LEVEL_WIDTH_FLOAT - currentSprite.width)) && (numPixelsUnderlyingObjectsSurface <= currentSprite.width - 3)) {
+    // Check if a hole is present on the ground: scan the floor row under the Topi feet, ignoring two pixels on each
+    // side so the Topi has to be at least 3 pixels over the hole. Note that screen edges are not taken in consideration.
+    int floorCellY = (position.GetIntY() + boundingBox.upperBoundY) / CELL_HEIGHT;
+    int firstCellX = (position.GetIntX() + boundingBox.lowerBoundX + 2) / CELL_WIDTH;
+    int lastCellX = (position.GetIntX() + boundingBox.upperBoundX - 2) / CELL_WIDTH;
+    if ((underlyingObjectCandidate != nullptr) && !((position.GetRealX() < 0.0f) || (position.GetRealX() >= LEVEL_WIDTH_FLOAT - currentSprite.width)) && entityManager->GetTerrainGrid().FindHole(floorCellY, firstCellX, lastCellX).has_value()) {
         topiFoundAHoleOnTheFloor = true;
         objectToCarryId = underlyingObjectCandidate->id;
         //cout << " >>>>>>> TOPI NEED TO CARRY AN OBJECT OF TYPE: ";
@@ -186,7 +190,7 @@ void Topi::GetSolidCollisions(std::vector<ObjectCollision> &collisions, bool& to
 }
 
 void Topi::UpdateCollisions() {
-    std::vector<ObjectCollision> collisions;
+    collisions.clear();
     bool topiIsSuspendedInTheAir = false;
     bool topiFoundAHoleOnTheFloor = false;
 
@@ -196,22 +200,17 @@ void Topi::UpdateCollisions() {
     // Change state when Topi is suspended in the air (almost no ground under his feet).
     if (topiIsSuspendedInTheAir && (isGoingToPickUpIce || isGoingToRecover)) {
         // Ignore collision with current underlying object during Topi fall.
-        if (currentUnderlyingObject != nullptr && (std::find(objectsToIgnoreDuringFall.begin(), objectsToIgnoreDuringFall.end(), currentUnderlyingObject) == objectsToIgnoreDuringFall.end())) {
-            objectsToIgnoreDuringFall.push_back(currentUnderlyingObject);
-
-            // Also ignore collisions with nearby objects around the currentUnderlyingObject
-            std::array<int, 2> index = {-1, 1};
-            for (size_t i = 0; i < index.size(); ++i) {
-                int x = (currentUnderlyingObject->position.GetCellX() + index[i]) * CELL_WIDTH;
-                int y = currentUnderlyingObject->position.GetCellY() * CELL_HEIGHT;
-                std::vector<int> lowerBound{x, y};
-                std::vector<int> upperBound{x + CELL_WIDTH, y + CELL_HEIGHT};
-                std::vector<aabb::AABBIntersection<IEntity*>> objectIntersections = spacePartitionObjectsTree->query(lowerBound, upperBound);
-
-                for (auto intersection : objectIntersections) {
-                    if (intersection.particle != currentUnderlyingObject) {
-                        objectsToIgnoreDuringFall.push_back(intersection.particle);
-                    }
+        if (currentUnderlyingObject != nullptr && !IsIgnoredDuringFall(currentUnderlyingObject)) {
+            objectsToIgnoreDuringFall.push_back(currentUnderlyingObject->handle);
+
+            // Also ignore collisions with the bricks next to the currentUnderlyingObject
+            const TerrainGrid& terrainGrid = entityManager->GetTerrainGrid();
+            int cell_x = currentUnderlyingObject->position.GetCellX();
+            int cell_y = currentUnderlyingObject->position.GetCellY();
+            for (int i : {-1, 1}) {
+                std::optional<EntityHandle> handle = terrainGrid.GetHandle(cell_x + i, cell_y);
+                if (handle.has_value() && (*handle != currentUnderlyingObject->handle)) {
+                    objectsToIgnoreDuringFall.push_back(*handle);
                 }
             }
         }
@@ -294,7 +293,7 @@ void Topi::LoadNextSprite() {
         }
     }
 
-    nextSpriteTime = (chrono::system_clock::now() + chrono::milliseconds(spriteData.duration));
+    ScheduleNextSprite(spriteData.durationTicks);
 
     currentSprite.width = spriteData.width;
     currentSprite.height = spriteData.height;
@@ -304,6 +303,7 @@ void Topi::LoadNextSprite() {
     currentSprite.v1 = spriteData.v1;
     currentSprite.u2 = spriteData.u2;
     currentSprite.v2 = spriteData.v2;
+    currentSprite.areas = spriteData.areas;
 
     // Adjusts object position according to the sprite offset
     PositionSetOffset(spriteData.xOffset, spriteData.yOffset);
@@ -430,7 +430,7 @@ void Topi::STATE_Bring_Ice_Right() {
     // Create a block of ice on the right side of the Topi
     int cell_x = position.GetCellX() + (Width() / CELL_WIDTH);
     int cell_y = position.GetCellY();
-    entityManager->CreateEntityWithId(EntityIdentificator::ICE, cell_x, cell_y);
+    entityManager->Spawn(EntityIdentificator::ICE, cell_x, cell_y);
 }
 
 void Topi::STATE_Bring_Ice_Left() {
@@ -447,7 +447,7 @@ void Topi::STATE_Bring_Ice_Left() {
     // Create a block of ice on the left side of the Topi
     int cell_x = position.GetCellX() - 1;
     int cell_y = position.GetCellY();
-    entityManager->CreateEntityWithId(EntityIdentificator::ICE, cell_x, cell_y);
+    entityManager->Spawn(EntityIdentificator::ICE, cell_x, cell_y);
 }
 
 void Topi::HoleDetectedWhenWalking() {
@@ -21,12 +21,15 @@ class Topi: public IEntity
   Direction direction;
   void LoadNextSprite();
   void GetSolidCollisions(std::vector<ObjectCollision>&, bool&, bool&);
+  std::vector<aabb::AABBIntersection<IEntity*>> objectIntersections; // Reused query buffers, so collision checks do not allocate
+  std::vector<ObjectCollision> collisions;
   bool ReachedScreenEdge();
   void SetRandomWalkStartPosition();
 
   std::optional<EntityIdentificator> objectToCarryId;
   IEntity* currentUnderlyingObject = nullptr;
-  std::vector<IEntity*> objectsToIgnoreDuringFall;
+  std::vector<EntityHandle> objectsToIgnoreDuringFall; // Handles do not dangle if the objects are deleted meanwhile
+  bool IsIgnoredDuringFall(IEntity*);
 
   // Topi action states
   bool isWalking = false;          // Topi is walking on a floor
@@ -45,7 +48,6 @@ class Topi: public IEntity
   ~Topi() override;
   void InitWithSpriteSheet(EntitySpriteSheet*) override;
   void PrintName() override;
-  bool IsTopi() override;
   bool Update(uint8_t) override;
   static IEntity* Create();
 
@@ -1,12 +1,13 @@
 #include <entities/water.h>
-#include <chrono>
 
 Water::Water() :
         IEntity(EntityIdentificator::WATER, EntityType::TERRAIN, SurfaceType::SIMPLE, WaterStateIdentificator::WATER_MAX_STATES, false, true) {
+        updatesEveryTick = false; // Only animated, woken up by the animation scheduler
 }
 
 Water::Water(EntityIdentificator _id, EntityType _type, SurfaceType surface_type, unsigned char max_states, bool is_breakable, bool is_traversable) :
         IEntity(_id, _type, surface_type, max_states, is_breakable, is_traversable) {
+        updatesEveryTick = false;
 }
 
 void Water::PrintName() {
@@ -24,7 +25,7 @@ bool Water::Update(uint8_t pressedKeys_) {
                 return false;
         }
 
-        if(chrono::system_clock::now() >= nextSpriteTime) {
+        if(NextSpriteIsDue()) {
                 // Load next sprite of the current animation
                 LoadNextSprite();
                 return true;
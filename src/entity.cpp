@@ -1,11 +1,16 @@
 #include <entity.h>
+#include <entity_manager.h>
 #include <collision/collision.h>
-#include <MersenneTwister/MersenneTwister.h>
+
+// Sequential ids: the space partition tree orders its particles by uniqueId, so two live objects must never share one.
+uint32_t IEntity::NextUniqueId() {
+  static uint32_t nextUniqueId = 0;
+  return ++nextUniqueId;
+}
 
 IEntity::IEntity() {
   id = EntityIdentificator::NONE;
-  MersenneTwister rng;
-  uniqueId = rng.integer(0, UINT_MAX);
+  uniqueId = NextUniqueId();
   boundingBox = solidBoundingBox = {0, 0, 0, 0};
   vectorDirection.x = 0;
   vectorDirection.y = 0;
@@ -22,16 +27,16 @@ IEntity::IEntity(EntityIdentificator _id, EntityType _type, SurfaceType surface_
   surfaceType(surface_type),
   isBreakable(_isBreakable),
   isTraversable(_isTraversable) {
-  MersenneTwister rng;
-  uniqueId = rng.integer(0, UINT_MAX);
+  uniqueId = NextUniqueId();
+  collisionCategory = isTraversable ? COLLISION_CATEGORY_SCENERY : COLLISION_CATEGORY_SOLID;
   boundingBox = solidBoundingBox = {0, 0, 0, 0};
   vectorDirection.x = 0;
   vectorDirection.y = 0;
   recalculateAreasDataIsNeeded = true;
 }
 
-void IEntity::SetSpacePartitionObjectsTree(aabb::Tree<IEntity*> *_spacePartitionObjectsTree) {
-  spacePartitionObjectsTree = _spacePartitionObjectsTree;
+void IEntity::SetBroadphase(Broadphase *_broadphase) {
+  broadphase = _broadphase;
 }
 
 void IEntity::SetEntityManager(EntityManager *_entityManager) {
@@ -97,18 +102,18 @@ void IEntity::PositionSetOffset(int16_t x, int16_t y) {
 }
 
 void IEntity::RemoveFromSpacePartitionObjectsTree() {
-  spacePartitionObjectsTree->removeParticle(this);
+  broadphase->Remove(this);
 }
 
 void IEntity::LoadAnimationWithId(uint16_t animationId) {
-    std::optional<EntitySpriteSheetAnimation *> currentAnimation = spriteSheet->GetAnimationWithId(animationId);
-    assert(currentAnimation != std::nullopt);
-    currentAnimationSprites = (*currentAnimation)->GetSprites();
-    animationHasOnlyOneSprite = (currentAnimationSprites.size() <= 1);
-    currentAnimationSpriteIterator = std::begin(currentAnimationSprites);
+    std::optional<uint32_t> animation = spriteSheet->GetAnimationWithId(animationId);
+    assert(animation != std::nullopt);
+    currentAnimation = *animation;
+    currentAnimationFrame = 0;
+    animationHasOnlyOneSprite = (spriteSheet->GetAnimationTable().GetSpriteCount(currentAnimation) <= 1);
     animationLoaded = true;
     firstSpriteOfCurrentAnimationIsLoaded = false;
-    nextSpriteTime = std::chrono::system_clock::now();
+    ScheduleNextSprite(0); // The first sprite is loaded by the next update
 }
 
 void IEntity::LoadNextSprite()
@@ -120,8 +125,6 @@ void IEntity::LoadNextSprite()
           }
   }
 
-  nextSpriteTime = (chrono::system_clock::now() + std::chrono::milliseconds(spriteData.duration));
-
   currentSprite.width = spriteData.width;
   currentSprite.height = spriteData.height;
   currentSprite.xOffset = spriteData.xOffset;
@@ -134,15 +137,42 @@ void IEntity::LoadNextSprite()
   recalculateAreasDataIsNeeded = true; // Is necessary because the current sprite may have different areas
   boundingBox = { spriteData.lowerBoundX, spriteData.lowerBoundY, spriteData.upperBoundX, spriteData.upperBoundY };
   firstSpriteOfCurrentAnimationIsLoaded = true;
+  ScheduleNextSprite(spriteData.durationTicks);
 }
 
+// The next sprite is due durationTicks from now. Objects that are not updated every tick are woken up by the animation
+// scheduler by then, unless they show the only sprite of their animation.
+void IEntity::ScheduleNextSprite(int durationTicks) {
+  if (entityManager == nullptr) {
+    return;
+  }
+
+  nextSpriteTick = entityManager->GetTick() + durationTicks;
+  if (!updatesEveryTick && !(animationHasOnlyOneSprite && firstSpriteOfCurrentAnimationIsLoaded)) {
+    animationWakeUpTick = entityManager->ScheduleAnimationWakeUp(this, animationWakeUpTick, nextSpriteTick);
+  } else if (animationWakeUpTick != 0) {
+    entityManager->CancelAnimationWakeUp(this, animationWakeUpTick);
+    animationWakeUpTick = 0;
+  }
+}
+
+// Objects outside of an EntityManager (e.g. benchmarks) have no tick, their sprites are always due.
+bool IEntity::NextSpriteIsDue() {
+  return entityManager == nullptr || entityManager->GetTick() >= nextSpriteTick;
+}
+
+// Copy of the next sprite of the current animation. beginNewLoop is set when the animation starts over.
 SpriteData IEntity::NextSpriteData() {
-    if (currentAnimationSpriteIterator == std::end(currentAnimationSprites)) {
-        currentAnimationSpriteIterator = std::begin(currentAnimationSprites);
-        (*currentAnimationSpriteIterator).beginNewLoop = true;
+    const AnimationTable& animationTable = spriteSheet->GetAnimationTable();
+    bool beginNewLoop = false;
+    if (currentAnimationFrame == animationTable.GetSpriteCount(currentAnimation)) {
+        currentAnimationFrame = 0;
+        beginNewLoop = true;
     }
 
-    return *currentAnimationSpriteIterator++;
+    SpriteData spriteData = animationTable.GetSprite(currentAnimation, currentAnimationFrame++);
+    spriteData.beginNewLoop = beginNewLoop;
+    return spriteData;
 }
 
 bool IEntity::ShouldBeginAnimationLoopAgain()
@@ -150,24 +180,15 @@ bool IEntity::ShouldBeginAnimationLoopAgain()
     return false;
 }
 
-std::vector<int> IEntity::GetLowerBound() {
-  std::vector<int> lowerBound{position.GetIntX() + boundingBox.lowerBoundX, position.GetIntY() + boundingBox.lowerBoundY};
-  return lowerBound;
+// Absolute boxes of the object (used by the space partition tree), computed on the stack.
+aabb::Bounds2i IEntity::GetBounds() {
+  return {position.GetIntX() + boundingBox.lowerBoundX, position.GetIntY() + boundingBox.lowerBoundY,
+          position.GetIntX() + boundingBox.upperBoundX, position.GetIntY() + boundingBox.upperBoundY};
 }
 
-std::vector<int> IEntity::GetUpperBound() {
-  std::vector<int> upperBound{position.GetIntX() + boundingBox.upperBoundX, position.GetIntY() + boundingBox.upperBoundY};
-  return upperBound;
-}
-
-std::vector<int> IEntity::GetSolidLowerBound() {
-  std::vector<int> lowerBound{position.GetIntX() + solidBoundingBox.lowerBoundX, position.GetIntY() + solidBoundingBox.lowerBoundY};
-  return lowerBound;
-}
-
-std::vector<int> IEntity::GetSolidUpperBound() {
-  std::vector<int> upperBound{position.GetIntX() + solidBoundingBox.upperBoundX, position.GetIntY() + solidBoundingBox.upperBoundY};
-  return upperBound;
+aabb::Bounds2i IEntity::GetSolidBounds() {
+  return {position.GetIntX() + solidBoundingBox.lowerBoundX, position.GetIntY() + solidBoundingBox.lowerBoundY,
+          position.GetIntX() + solidBoundingBox.upperBoundX, position.GetIntY() + solidBoundingBox.upperBoundY};
 }
 
 Boundaries IEntity::GetAbsoluteBoundaries() {
@@ -204,24 +225,17 @@ void IEntity::PrintName() {
   std::cout << "PrintName not overloaded for object." << std::endl;
 }
 
-bool IEntity::IsCloud() {
-  return false;
-}
-
-bool IEntity::IsTopi() {
-  return false;
+bool IEntity::HasStaticSprite() {
+  return animationHasOnlyOneSprite;
 }
 
 void IEntity::UpdatePositionInSpacePartitionTree() {
-    std::vector<int> lowerBound = GetLowerBound();
-    std::vector<int> upperBound = GetUpperBound();
-    spacePartitionObjectsTree->updateParticle(this, lowerBound, upperBound);
+    broadphase->Update(this, GetBounds());
 }
 
 void IEntity::PrintBoundaries() {
-  std::vector<int> lowerBound = GetLowerBound();
-  std::vector<int> upperBound = GetUpperBound();
-  std:cout << "Lowerbound X: " << lowerBound[0] << " Y: " << lowerBound[1] << " | Upperbound X: " << upperBound[0] << " Y: " << upperBound[1] << endl;
+  aabb::Bounds2i bounds = GetBounds();
+  std::cout << "Lowerbound X: " << bounds.lowerX << " Y: " << bounds.lowerY << " | Upperbound X: " << bounds.upperX << " Y: " << bounds.upperY << endl;
 }
 
 bool IEntity::Update() {
@@ -232,10 +246,6 @@ bool IEntity::Update(const uint8_t pressedKeys) {
   return false;
 }
 
-bool IEntity::Update(const uint8_t pressedKeys, aabb::Tree<IEntity*>& spacePartitionObjectsTree) {
-  return false;
-}
-
 void IEntity::InitWithSpriteSheet(EntitySpriteSheet *_spriteSheet) {
   spriteSheet = _spriteSheet;
 }
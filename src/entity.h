@@ -2,13 +2,15 @@
 #define ENTITY_H
 
 #include <iostream>
-#include <chrono>
 #include <position.h>
 #include <defines.h>
 #include <entity_sprite_sheet.h>
 #include <sprite.h>
 #include <state_machine.h>
+#include <slot_map.h>
+#include <broadphase.h>
 #include <AABB/AABB.h>
+#include <collision/structures/vec2.hpp>
 
 using namespace std;
 
@@ -25,12 +27,12 @@ class IEntity : public StateMachine
   std::vector<Boundaries> simpleAreas;
 protected:
   EntityManager *entityManager = nullptr;
-  aabb::Tree<IEntity*> *spacePartitionObjectsTree = nullptr;
-  std::vector<SpriteData> currentAnimationSprites;
-  std::vector<SpriteData>::iterator currentAnimationSpriteIterator;
+  Broadphase *broadphase = nullptr;
+  uint32_t currentAnimation = 0; // Index in the animation table of the sprite sheet
+  uint32_t currentAnimationFrame = 0; // Frame of the current animation loaded by the next call to NextSpriteData
   EntitySpriteSheet *spriteSheet = nullptr;
   EntityType type;
-  chrono::system_clock::time_point nextSpriteTime;
+  uint64_t nextSpriteTick = 0; // Tick at which the next sprite of the current animation is due
   bool animationLoaded = false;
   bool firstSpriteOfCurrentAnimationIsLoaded = false;
   bool animationHasOnlyOneSprite = false;
@@ -39,7 +41,10 @@ class IEntity : public StateMachine
   void LoadAnimationWithId(uint16_t);
   void LoadNextSprite();
   SpriteData NextSpriteData();
+  void ScheduleNextSprite(int);
+  bool NextSpriteIsDue();
   bool ShouldBeginAnimationLoopAgain();
+  static uint32_t NextUniqueId();
 public:
   IEntity();
   IEntity(EntityIdentificator, EntityType, SurfaceType, unsigned char, bool, bool);
@@ -51,10 +56,18 @@ class IEntity : public StateMachine
   Boundaries solidBoundingBox;
   collision::vec2<int16_t> vectorDirection;
   uint32_t uniqueId;
+  EntityHandle handle; // Set by the EntityManager when the object is stored
   bool isBreakable = false;
   bool isTraversable = false;
   bool isMarkedToDelete = false;
-  void SetSpacePartitionObjectsTree(aabb::Tree<IEntity*>*);
+  bool isCachedTerrain = false; // Drawn from the render thread terrain cache instead of as an individual sprite
+  bool updatesEveryTick = true; // Otherwise the object is only updated when its next sprite is due, see AnimationScheduler
+  uint64_t animationWakeUpTick = 0; // Pending wake up in the animation scheduler, 0 when there is none
+  uint64_t broadphaseChangeStamp = 0; // Broadphase pass in which the object was last inserted, moved or removed
+  uint32_t actorPairsIndex = 0; // Candidates of the actor in the BroadphasePairs, valid for the pass that set it
+  uint16_t collisionCategory = COLLISION_CATEGORY_SOLID; // Stored in the broadphase with the box of the object
+  uint16_t collisionMask = COLLISION_CATEGORY_ALL; // Categories reported to the collision checks of the object
+  void SetBroadphase(Broadphase*);
   void SetEntityManager(EntityManager*);
   //std::vector<Area>& GetSolidAreas(); DEPRECATED Now this is GetAbsoluteSolidBoundaries
   //std::vector<Area>& GetSimpleAreas(); DEPRECATED Now this is GetAbsoluteSimpleBoundaries
@@ -64,10 +77,8 @@ class IEntity : public StateMachine
   void PositionSetY(float);
   void PositionAddX(float);
   void PositionAddY(float);
-  virtual std::vector<int> GetLowerBound();
-  virtual std::vector<int> GetUpperBound();
-  virtual std::vector<int> GetSolidLowerBound();
-  virtual std::vector<int> GetSolidUpperBound();
+  aabb::Bounds2i GetBounds();
+  aabb::Bounds2i GetSolidBounds();
   virtual Boundaries GetAbsoluteBoundaries();
   virtual Boundaries GetAbsoluteSolidBoundaries();
   virtual EntityIdentificator Id();
@@ -79,11 +90,11 @@ class IEntity : public StateMachine
   virtual void PrintBoundaries();
   virtual bool Update();
   virtual bool Update(const uint8_t);
-  virtual bool Update(const uint8_t, aabb::Tree<IEntity*>&);
   virtual void UpdatePositionInSpacePartitionTree();
   virtual void Hit(bool);
-  virtual bool IsCloud();
-  virtual bool IsTopi();
+  bool HasStaticSprite();
+  bool IsCloud() const { return collisionCategory == COLLISION_CATEGORY_CLOUD; }
+  bool IsTopi() const { return collisionCategory == COLLISION_CATEGORY_TOPI; }
 };
 
 typedef IEntity* (*CreateEntityFn)(void);
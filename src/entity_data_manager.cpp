@@ -1,14 +1,9 @@
 #include <entity_data_manager.h>
-#include <fstream>
-#include <sstream>
-#include <collision/collision.h>
-
-using namespace collision;
 
 EntityDataManager::EntityDataManager()
 {
         cout << "EntityDataManager created!" << endl;
-        LoadObjectsDataFromFile(ENTITY_TYPES_FILENAME);
+        LoadObjectsData(ENTITY_TYPES_FILENAME, ENTITY_TYPES_CACHE_FILENAME);
         Print();
 }
 
@@ -31,106 +26,51 @@ void EntityDataManager::Print()
         }
 }
 
-void EntityDataManager::LoadObjectsDataFromFile(std::string filename)
+// Maps the binary cache of the entity types file, which stays mapped while the game runs. When it is missing or
+// stale, the text file is compiled instead and the cache is written for the next run.
+void EntityDataManager::LoadObjectsData(std::string filename, std::string cacheFilename)
 {
-        enum LineType { OBJ_TEX_FILENAME, OBJ_ID, OBJ_ANIMATION_ID, OBJ_SPRITE, OBJ_SPRITE_COLLISION_AREA };
-
-        std::ifstream infile(filename);
-        std::string line;
-        EntitySpriteSheet *currentEntitySpriteSheet;
-        EntitySpriteSheetAnimation *currentEntitySpriteSheetAnimation;
-        uint16_t currentEntitySpriteSheetAnimationId;
-        SpriteAreas *currentAreas;
-
-        while (std::getline(infile, line))
-        {
-                std::istringstream iss(line);
-                string token;
-                bool commentFound = false;
-                std::vector<string> *currentFrameValues = new std::vector<string>;
-                LineType currentLineType;
-
-                while((iss >> token) && (!commentFound)) {
-                        if(startsWith(token, "//")) {
-                                commentFound = true;
-                        } else if(startsWith(token, "###")) {
-                                currentLineType = OBJ_TEX_FILENAME;
-                                textureFilename = token.substr(3);
-                        } else if(startsWith(token, "##")) {
-                                currentLineType = OBJ_ID;
-                                EntityIdentificator entityId = (EntityIdentificator)std::stoi(token.substr(2));
-                                currentEntitySpriteSheet = new EntitySpriteSheet(entityId);
-                                entitySpriteSheetsMap[entityId] = currentEntitySpriteSheet;
-                        } else if(startsWith(token, "#")) {
-                                currentLineType = OBJ_ANIMATION_ID;
-                                uint16_t entitySpriteSheetAnimationId = std::stoi(token.substr(1));
-                                currentEntitySpriteSheetAnimation = new EntitySpriteSheetAnimation(entitySpriteSheetAnimationId);
-                                currentEntitySpriteSheet->AddAnimation(currentEntitySpriteSheetAnimation);
-                        } else if(startsWith(token, "_")) {
-                                currentLineType = OBJ_SPRITE_COLLISION_AREA;
-                                uint16_t collisionAreaId = std::stoi(token.substr(1));
-                                iss >> token;
-                                string collisionAreaType = token; // Type is a string value
-
-                                // Creates a temporal vector of tokens of the current line being processed
-                                std::vector<float> *currentCollisionAreaValues = new std::vector<float>;
-
-                                while(iss >> token) {
-                                  currentCollisionAreaValues->push_back(stof(token));
-                                }
-
-                                // Load polygon points to a vector of points
-                                std::vector<vec2<float>> points;
-                                for(uint16_t i=0; i<currentCollisionAreaValues->size(); i+=2) {
-                                  points.push_back(vec2<float>(currentCollisionAreaValues->at(i), currentCollisionAreaValues->at(i+1)));
-                                }
+        loadedFromCache = cache.Open(cacheFilename, filename);
+        if (loadedFromCache) {
+                LoadObjectsData(cache.Tables());
+                return;
+        }
 
-                                delete currentCollisionAreaValues;
-                                // Initializes a polygon from the array of points
-                                collision::Rectangle rectangle(points);
+        if (!CompileAssets(filename, compiledAssets)) {
+                cout << "Unable to read " << filename << endl;
+                return;
+        }
 
-                                // If the polygon corresponds to a solid area then add the polygon to the solidArea vector, otherwise add the polygon to simpleAreas
-                                if(collisionAreaType=="solid") {
-                                  currentAreas->solidAreas.push_back({ collisionAreaId, rectangle });
-                                } else if(collisionAreaType=="simple") {
-                                  currentAreas->simpleAreas.push_back({ collisionAreaId, rectangle });
-                                }
+        LoadObjectsData(compiledAssets.Tables());
+        if (!WriteAssetCache(cacheFilename, filename, compiledAssets)) {
+                cout << "Unable to write " << cacheFilename << endl;
+        }
+}
 
-                        } else {
-                                currentLineType = OBJ_SPRITE;
-                                currentFrameValues->push_back(token);
-                        }
-                }
+// Creates the sprite sheets from the compiled tables. The animation table uses the tables in place, so animation a of
+// the tables is animation a of the table.
+void EntityDataManager::LoadObjectsData(const AssetTables& tables)
+{
+        textureFilename.assign(tables.textureFilename, tables.textureFilenameLength);
+        animationTable.View(tables);
 
-                if(currentLineType == OBJ_SPRITE) {
-                        if(currentFrameValues->size() == 13) {
-                                int width = stoi(currentFrameValues->at(0));
-                                int height = stoi(currentFrameValues->at(1));
-                                int xOffset = stoi(currentFrameValues->at(2));
-                                int yOffset = stoi(currentFrameValues->at(3));
-                                float u1 = stof(currentFrameValues->at(4));
-                                float v1 = stof(currentFrameValues->at(5));
-                                float u2 = stof(currentFrameValues->at(6));
-                                float v2 = stof(currentFrameValues->at(7));
-                                int duration = stoi(currentFrameValues->at(8));
-                                int lowerBoundX = stoi(currentFrameValues->at(9));
-                                int lowerBoundY = stoi(currentFrameValues->at(10));
-                                int upperBoundX = stoi(currentFrameValues->at(11));
-                                int upperBoundY = stoi(currentFrameValues->at(12));
+        for (uint32_t s = 0; s < tables.sheetCount; s++) {
+                const AssetSpriteSheet& sheet = tables.sheets[s];
+                EntityIdentificator entityId = (EntityIdentificator)sheet.entityId;
+                EntitySpriteSheet *entitySpriteSheet = new EntitySpriteSheet(entityId, &animationTable);
+                entitySpriteSheetsMap[entityId] = entitySpriteSheet;
 
-                                // An sprite may contain some areas defined by polygons in order to check possible collisions with other objects during the gameplay
-                                currentAreas = new SpriteAreas();
-                                currentEntitySpriteSheetAnimation->AddSprite({ width, height, xOffset, yOffset, u1, v1, u2, v2, duration, false, lowerBoundX, lowerBoundY, upperBoundX, upperBoundY, currentAreas });
-                        }
+                for (uint32_t a = sheet.firstAnimation; a < sheet.firstAnimation + sheet.animationCount; a++) {
+                        entitySpriteSheet->AddAnimation(tables.animations[a].animationId, a);
                 }
-
-                delete currentFrameValues;
         }
 }
 
+#ifndef IC_HEADLESS
 Texture2D EntityDataManager::LoadTextureAtlas() {
         return LoadTexture(FileSystem::getPath(textureFilename).c_str());
 }
+#endif
 
 std::optional<EntitySpriteSheet*> EntityDataManager::GetSpriteSheetByEntityIdentificator(EntityIdentificator sceneObjectIdentificator) {
         auto searchIterator = entitySpriteSheetsMap.find(sceneObjectIdentificator);
@@ -140,13 +80,3 @@ std::optional<EntitySpriteSheet*> EntityDataManager::GetSpriteSheetByEntityIdent
 
         return std::nullopt;
 }
-
-bool startsWith(std::string mainStr, std::string toMatch)
-{
-        // Convert mainStr to lower case
-        std::transform(mainStr.begin(), mainStr.end(), mainStr.begin(), ::tolower);
-        // Convert toMatch to lower case
-        std::transform(toMatch.begin(), toMatch.end(), toMatch.begin(), ::tolower);
-
-        return (mainStr.find(toMatch) == 0);
-}
@@ -6,6 +6,7 @@
 #include <map>
 #include <optional>
 #include <entity_sprite_sheet.h>
+#include <asset_cache.h>
 #include <raylib/raylib.h>
 #include <filesystem.h>
 
@@ -15,16 +16,21 @@ class EntityDataManager
 {
   typedef map<EntityIdentificator, EntitySpriteSheet*> SpriteSheetsMap;
   SpriteSheetsMap entitySpriteSheetsMap;
+  MappedAssetCache cache; // Compiled entity types, mapped from the cache file...
+  CompiledAssets compiledAssets; // ...or compiled from the text file when the cache is missing or stale
+  AnimationTable animationTable; // Frames of the animations of every sprite sheet, viewed in the compiled entity types
   std::string textureFilename;
   uint32_t textureId;
-  void LoadObjectsDataFromFile(std::string filename);
+  bool loadedFromCache = false;
+  void LoadObjectsData(std::string filename, std::string cacheFilename);
+  void LoadObjectsData(const AssetTables&);
   void Print();
 public:
   EntityDataManager();
   ~EntityDataManager();
   Texture2D LoadTextureAtlas();
   std::optional<EntitySpriteSheet*> GetSpriteSheetByEntityIdentificator(EntityIdentificator);
+  bool LoadedFromCache() const { return loadedFromCache; }
 };
 
-bool startsWith(std::string mainStr, std::string toMatch);
 #endif
@@ -2,11 +2,12 @@
 #include <entity_sprite_sheet.h>
 #include <map>
 
-EntityFactory::EntityFactory(EntityManager* _entityManager, EntityDataManager* _textureManager, aabb::Tree<IEntity*>* _spacePartitionObjectsTree) {
+EntityFactory::EntityFactory(EntityManager* _entityManager, EntityDataManager* _textureManager, Broadphase* _broadphase) {
 	entityManager = _entityManager;
 	textureManager = _textureManager;
-	spacePartitionObjectsTree = _spacePartitionObjectsTree;
+	broadphase = _broadphase;
 	RegisterEntities();
+	RegisterPools();
 }
 
 void EntityFactory::RegisterEntities() {
@@ -55,12 +56,33 @@ void EntityFactory::RegisterEntities() {
 	Register(EntityIdentificator::BONUS_STAGE_TEXT, &BonusStageText::Create);
 }
 
+// Types created while playing: blocks of ice brought by the Topis and the bricks filling the holes they cover
+void EntityFactory::RegisterPools() {
+	RegisterPool<Ice>(EntityIdentificator::ICE, ICE_POOL_CAPACITY);
+	RegisterPool<Brick>(EntityIdentificator::BRICK, BRICK_POOL_CAPACITY);
+	RegisterPool<BrickBrown>(EntityIdentificator::BRICK_BROWN, BRICK_POOL_CAPACITY);
+	RegisterPool<BrickBlue>(EntityIdentificator::BRICK_BLUE, BRICK_POOL_CAPACITY);
+	RegisterPool<BrickGreenHalf>(EntityIdentificator::BRICK_GREEN_HALF, BRICK_POOL_CAPACITY);
+	RegisterPool<BrickBrownHalf>(EntityIdentificator::BRICK_BROWN_HALF, BRICK_POOL_CAPACITY);
+	RegisterPool<BrickBlueHalf>(EntityIdentificator::BRICK_BLUE_HALF, BRICK_POOL_CAPACITY);
+	RegisterPool<BrickBlueConveyorBeltRight>(EntityIdentificator::BRICK_BLUE_CONVEYOR_BELT_RIGHT, BRICK_POOL_CAPACITY);
+	RegisterPool<BrickBlueConveyorBeltLeft>(EntityIdentificator::BRICK_BLUE_CONVEYOR_BELT_LEFT, BRICK_POOL_CAPACITY);
+	RegisterPool<BrickBrownConveyorBeltRight>(EntityIdentificator::BRICK_BROWN_CONVEYOR_BELT_RIGHT, BRICK_POOL_CAPACITY);
+	RegisterPool<BrickBrownConveyorBeltLeft>(EntityIdentificator::BRICK_BROWN_CONVEYOR_BELT_LEFT, BRICK_POOL_CAPACITY);
+	RegisterPool<BrickGreenConveyorBeltRight>(EntityIdentificator::BRICK_GREEN_CONVEYOR_BELT_RIGHT, BRICK_POOL_CAPACITY);
+	RegisterPool<BrickGreenConveyorBeltLeft>(EntityIdentificator::BRICK_GREEN_CONVEYOR_BELT_LEFT, BRICK_POOL_CAPACITY);
+}
+
 EntityFactory &EntityFactory::operator=(const EntityFactory &) {
 	return *this;
 }
 
 EntityFactory::~EntityFactory() {
 	m_FactoryMap.clear();
+	for (auto& entry : m_PoolMap) {
+		delete entry.second;
+	}
+	m_PoolMap.clear();
 }
 
 void EntityFactory::Register(const EntityIdentificator sceneObjectId, CreateEntityFn pfnCreate)
@@ -68,15 +90,25 @@ void EntityFactory::Register(const EntityIdentificator sceneObjectId, CreateEnti
 	m_FactoryMap[sceneObjectId] = pfnCreate;
 }
 
-std::optional<IEntity*> EntityFactory::CreateEntity(const EntityIdentificator sceneObjectId)
+// Pooled objects are taken from the pool of their type when it has a free slot, otherwise they are allocated.
+std::optional<IEntity*> EntityFactory::CreateEntity(const EntityIdentificator sceneObjectId, bool pooled)
 {
 	FactoryMap::iterator it = m_FactoryMap.find(sceneObjectId);
 	if( it != m_FactoryMap.end() ) {
-		IEntity *sceneObject = it->second();
+		IEntity *sceneObject = nullptr;
+		if (pooled) {
+			PoolMap::iterator pool = m_PoolMap.find(sceneObjectId);
+			if (pool != m_PoolMap.end()) {
+				sceneObject = pool->second->Acquire();
+			}
+		}
+		if (sceneObject == nullptr) {
+			sceneObject = it->second();
+		}
 		std::optional<EntitySpriteSheet *> entitySpriteSheet = textureManager->GetSpriteSheetByEntityIdentificator(sceneObject->Id());
 		assert(entitySpriteSheet != std::nullopt);
 		sceneObject->SetEntityManager(entityManager);
-		sceneObject->SetSpacePartitionObjectsTree(spacePartitionObjectsTree);
+		sceneObject->SetBroadphase(broadphase);
 		sceneObject->InitWithSpriteSheet(*entitySpriteSheet);
 		return sceneObject;
 	}
@@ -84,8 +116,23 @@ std::optional<IEntity*> EntityFactory::CreateEntity(const EntityIdentificator sc
 	return std::nullopt;
 }
 
-EntityFactory *EntityFactory::Get(EntityManager* _entityManager, EntityDataManager* _textureManager, aabb::Tree<IEntity*>* _spacePartitionObjectsTree)
+void EntityFactory::DestroyEntity(IEntity* sceneObject)
 {
-	static EntityFactory instance(_entityManager, _textureManager, _spacePartitionObjectsTree);
+	PoolMap::iterator pool = m_PoolMap.find(sceneObject->Id());
+	if (pool != m_PoolMap.end() && pool->second->Release(sceneObject)) {
+		return;
+	}
+
+	delete sceneObject;
+}
+
+EntityFactory *EntityFactory::Get(EntityManager* _entityManager, EntityDataManager* _textureManager, Broadphase* _broadphase)
+{
+	static EntityFactory instance(_entityManager, _textureManager, _broadphase);
+
+	// Objects are always created for the last manager asking for them (e.g. a benchmark running one manager per broadphase)
+	instance.entityManager = _entityManager;
+	instance.textureManager = _textureManager;
+	instance.broadphase = _broadphase;
 	return &instance;
 }
@@ -7,6 +7,7 @@
 #include <entity.h>
 #include <entity_manager.h>
 #include <entity_data_manager.h>
+#include <object_pool.h>
 #include <entities/player.h>
 #include <entities/brick.h>
 #include <entities/side_wall.h>
@@ -18,22 +19,57 @@
 
 class EntityManager;
 
+// Recycled storage of the objects of a concrete type created while playing (e.g. blocks of ice or bricks filling a
+// hole), see ObjectPool.
+class IEntityPool
+{
+public:
+  virtual ~IEntityPool() {}
+  virtual IEntity* Acquire() = 0;
+  virtual bool Release(IEntity*) = 0; // False when the object does not belong to the pool
+};
+
+template <class T>
+class EntityPool : public IEntityPool
+{
+  ObjectPool<T> pool;
+public:
+  explicit EntityPool(uint32_t capacity) : pool(capacity) {}
+  IEntity* Acquire() override { return pool.Acquire(); }
+  bool Release(IEntity* object) override {
+    if (!pool.Owns(object)) {
+      return false;
+    }
+    pool.Release(static_cast<T*>(object));
+    return true;
+  }
+};
+
 class EntityFactory
 {
 private:
-  EntityFactory(EntityManager*, EntityDataManager*, aabb::Tree<IEntity*>*);
+  EntityFactory(EntityManager*, EntityDataManager*, Broadphase*);
   EntityFactory &operator=(const EntityFactory &);
   void RegisterEntities();
+  void RegisterPools();
+  template <class T> void RegisterPool(const EntityIdentificator sceneObjectId, uint32_t capacity) {
+    m_PoolMap[sceneObjectId] = new EntityPool<T>(capacity);
+  }
   typedef map<EntityIdentificator, CreateEntityFn> FactoryMap;
+  typedef map<EntityIdentificator, IEntityPool*> PoolMap;
   FactoryMap m_FactoryMap;
+  PoolMap m_PoolMap;
   EntityManager *entityManager = nullptr;
   EntityDataManager *textureManager = nullptr;
-  aabb::Tree<IEntity*> *spacePartitionObjectsTree = nullptr;
+  Broadphase *broadphase = nullptr;
 public:
 	~EntityFactory();
-	static EntityFactory *Get(EntityManager*, EntityDataManager*, aabb::Tree<IEntity*>*);
+	static EntityFactory *Get(EntityManager*, EntityDataManager*, Broadphase*);
 	void Register(const EntityIdentificator, CreateEntityFn);
-	std::optional<IEntity*> CreateEntity(const EntityIdentificator);
+	static constexpr uint32_t ICE_POOL_CAPACITY = 16;
+	static constexpr uint32_t BRICK_POOL_CAPACITY = 8; // Per brick type
+	std::optional<IEntity*> CreateEntity(const EntityIdentificator, bool pooled = false);
+	void DestroyEntity(IEntity*);
 };
 
 #endif
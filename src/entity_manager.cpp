@@ -1,40 +1,145 @@
+#include <cmath>
+#include <algorithm>
 #include <entity_manager.h>
 #include <entity_factory.h>
 #include <entity.h>
 
-EntityManager::EntityManager(EntityDataManager* _textureManager, SpriteRectDoubleBuffer* _spriteRectDoubleBuffer, uint32_t _maxObjects) {
+EntityManager::EntityManager(EntityDataManager* _textureManager, SpriteRectTripleBuffer* _spriteRectTripleBuffer, InputQueue* _inputQueue, uint32_t _maxObjects, BroadphaseType broadphaseType, const std::string& mountainFilename) {
         textureManager = _textureManager;
-        spriteRectDoubleBuffer = _spriteRectDoubleBuffer;
+        spriteRectTripleBuffer = _spriteRectTripleBuffer;
+        inputQueue = _inputQueue;
+        heldKeys = IC_KEY_NONE;
+        inputLatency = 0.0f;
         maxObjects = _maxObjects;
-        spacePartitionObjectsTree = new aabb::Tree<IEntity*>();
-        spacePartitionObjectsTree->setDimension(2);
+        broadphase = CreateBroadphase(broadphaseType);
+        broadphasePairs = new BroadphasePairs(broadphase);
         currentEscalatedHeight = 0; // height climbed
         cameraIsMoving = false;
         currentRow = 0;
-        visibleRows = 56;
-        currentCameraPosition = newCameraPosition = 0.0f;
+        visibleRows = VIEWPORT_HEIGHT_CELLS + 2 * CULLING_MARGIN_ROWS;
+        currentCameraPosition = newCameraPosition = previousCameraPosition = 0.0f;
+        tick = 0;
+
+        // Without a mountain there is nothing to run. The caller checks IsLoaded.
+        if (!level.Load(mountainFilename, LevelMap::CacheFilename(mountainFilename), TERRAIN_CHUNK_ROWS)) {
+                cout << "Unable to load " << mountainFilename << endl;
+                return;
+        }
+        if (level.Columns() != map_viewport_width || level.Rows() == 0) {
+                cout << "Wrong size of " << mountainFilename << ": " << level.Columns() << "x" << level.Rows() << " cells" << endl;
+                return;
+        }
+        map_rows = level.Rows();
+        staticObjectsByRow.resize(map_rows);
+        terrainChunkVersions.resize((map_rows + TERRAIN_CHUNK_ROWS - 1) / TERRAIN_CHUNK_ROWS, 0);
+        terrainChunkSentVersions.resize(terrainChunkVersions.size(), 0);
+        terrainChunkSentTicks.resize(terrainChunkVersions.size(), 0);
+        terrainGrid.Resize(map_viewport_width, map_rows);
         BuildMountain();
+        if (player == nullptr) {
+                cout << "No player at the start of " << mountainFilename << endl;
+                return;
+        }
+        loaded = true;
 }
 
+// Creates the bands of the map around the initial camera position. The rest are created while climbing, see
+// streamBands.
 void EntityManager::BuildMountain() {
-  // Each level is six cells height. The entire mountain have 4 extra rows on top to enforce level floors to be
-  // located in vertical position multiple of six. One additional row is appended to show the water.
-  for(int row=0; row<4 + 30*6 + 1; row++) {
-    for(int col=0; col<map_viewport_width; col++) {
-      if(EntityIdentificator entity_id = (EntityIdentificator)mountainMap[row][col]) {
-        std::optional<IEntity *> entity_ptr = CreateEntityWithId(entity_id, col, row);
-      }
+  residentBands(INITIAL_CAMERA_POSITION, firstResidentBand, lastResidentBand);
+  for (int band = firstResidentBand; band <= lastResidentBand; band++) {
+    for (const LevelCell* cell = level.BandBegin(band); cell != level.BandEnd(band); cell++) {
+      CreateEntityWithId((EntityIdentificator)cell->entityId, cell->column, band * level.BandRows() + cell->row);
+    }
+  }
+
+  // Let the broadphase bulk build the motionless terrain in one pass
+  broadphase->BuildTerrain();
+}
+
+// Bands of the map holding the rows sent to the render thread for the given camera position, plus the bands just
+// above them, so the terrain is ready before the camera reaches it.
+void EntityManager::residentBands(float cameraPosition, int& firstBand, int& lastBand) {
+  int cameraRow = static_cast<int>(cameraPosition) / CELL_HEIGHT;
+  int firstRow = std::clamp(cameraRow - CULLING_MARGIN_ROWS, 0, map_rows - 1);
+  int lastRow = std::min(firstRow + static_cast<int>(visibleRows), map_rows) - 1;
+  firstBand = std::max(firstRow / level.BandRows() - STREAMED_BANDS_AHEAD, 0);
+  lastBand = lastRow / level.BandRows();
+}
+
+// The camera only moves up, so the bands it approaches are created and the bands it leaves behind are deleted for
+// good. The number of objects stays the same whatever the height of the mountain.
+void EntityManager::streamBands() {
+  int firstBand, lastBand;
+  residentBands(currentCameraPosition, firstBand, lastBand);
+
+  spawnInsertions.clear();
+  while (firstResidentBand > firstBand) {
+    loadBand(--firstResidentBand);
+    terrainBuildIsDue = true;
+  }
+  if (!spawnInsertions.empty()) {
+    broadphase->InsertBatch(spawnInsertions);
+  }
+
+  while (lastResidentBand > lastBand) {
+    unloadBand(lastResidentBand--);
+    terrainBuildIsDue = true;
+  }
+}
+
+// Creates the objects of a band. They are inserted into the broadphase in one batch by the caller.
+void EntityManager::loadBand(int band) {
+  for (const LevelCell* cell = level.BandBegin(band); cell != level.BandEnd(band); cell++) {
+    int row = band * level.BandRows() + cell->row;
+    if (std::optional<IEntity *> entity_ptr = createEntity((EntityIdentificator)cell->entityId, cell->column, row, false)) {
+      spawnInsertions.push_back(broadphaseInsertion(*entity_ptr));
+    }
+  }
+}
+
+// Deletes the terrain of a band and the enemies left on it or below it. The player always stays.
+void EntityManager::unloadBand(int band) {
+  int firstRow = band * level.BandRows();
+  int lastRow = std::min(firstRow + level.BandRows(), map_rows);
+  for (int row = firstRow; row < lastRow; row++) {
+    for (IEntity* entity_ptr : staticObjectsByRow[row]) {
+      Despawn(entity_ptr);
+    }
+  }
+
+  float bandTop = firstRow * CELL_HEIGHT_FLOAT;
+  for (IEntity* entity_ptr : objects) {
+    if (entity_ptr->Type() == EntityType::ENEMY && entity_ptr->position.GetY() >= bandTop) {
+      Despawn(entity_ptr);
     }
   }
 }
 
 std::optional<IEntity *> EntityManager::CreateEntityWithId(EntityIdentificator entity_id, int x, int y) {
-  std::optional<IEntity *> entity_ptr = EntityFactory::Get(this, textureManager, spacePartitionObjectsTree)->CreateEntity(entity_id);
+  std::optional<IEntity *> entity_ptr = createEntity(entity_id, x, y, false);
+
+  if(entity_ptr.has_value()) {
+    BroadphaseInsertion insertion = broadphaseInsertion(*entity_ptr);
+    if (insertion.isTerrain) {
+      broadphase->InsertTerrain(insertion.particle, insertion.bounds, insertion.categories);
+    } else {
+      broadphase->Insert(insertion.particle, insertion.bounds, insertion.categories);
+    }
+  }
+
+  return entity_ptr;
+}
+
+// Creates the object and stores it, without inserting it into the broadphase. Pooled objects are recycled by the
+// factory when they are deleted.
+std::optional<IEntity *> EntityManager::createEntity(EntityIdentificator entity_id, int x, int y, bool pooled) {
+  std::optional<IEntity *> entity_ptr = EntityFactory::Get(this, textureManager, broadphase)->CreateEntity(entity_id, pooled);
 
   if(entity_ptr.has_value()) {
     if (entity_id == EntityIdentificator::POPO) {
       player = *entity_ptr;
-      currentCameraPosition = newCameraPosition = INITIAL_CAMERA_POSITION;
+      currentCameraPosition = newCameraPosition = previousCameraPosition = INITIAL_CAMERA_POSITION;
     }
 
     // Set the initial position of the object in the screen
@@ -43,19 +148,69 @@ std::optional<IEntity *> EntityManager::CreateEntityWithId(EntityIdentificator e
     // Initial update to load the sprites and boundary box
     (*entity_ptr)->Update();
 
-    // Insert the object into the space partition tree used for object collision detection
-    std::vector<int> lowerBound = (*entity_ptr)->GetLowerBound();
-    std::vector<int> upperBound = (*entity_ptr)->GetUpperBound();
-    spacePartitionObjectsTree->insertParticle(*entity_ptr, lowerBound, upperBound);
+    // Store the object and index the static ones by row
+    (*entity_ptr)->handle = objects.Insert(*entity_ptr);
+    if((*entity_ptr)->Type() == EntityType::TERRAIN) {
+      staticObjectsByRow[y].push_back(*entity_ptr);
 
-    // Save pointers to proper arrays for static objects and mobile objects
-    if((*entity_ptr)->Type() == EntityType::TERRAIN) staticObjects[(*entity_ptr)->uniqueId] = *entity_ptr;
-    else mobileObjects[(*entity_ptr)->uniqueId] = *entity_ptr;
+      // Solid bricks occupy their map cell. Side walls and water are traversable and clouds move.
+      if (!(*entity_ptr)->isTraversable && !(*entity_ptr)->IsCloud()) {
+        terrainGrid.Set(x, y, (*entity_ptr)->handle);
+      }
+
+      // Motionless terrain is drawn by the render thread terrain cache. New terrain (e.g. a hole filled with ice)
+      // invalidates the cached chunk.
+      if ((*entity_ptr)->HasStaticSprite() && !(*entity_ptr)->IsCloud()) {
+        (*entity_ptr)->isCachedTerrain = true;
+        terrainChunkVersions[y / TERRAIN_CHUNK_ROWS]++;
+      }
+    }
   }
 
   return entity_ptr;
 }
 
+// Motionless terrain is inserted as terrain, so the broadphase can bulk build it at the end of BuildMountain.
+BroadphaseInsertion EntityManager::broadphaseInsertion(IEntity* entity_ptr) {
+  bool isTerrain = entity_ptr->Type() == EntityType::TERRAIN && !entity_ptr->IsCloud();
+  return { entity_ptr, entity_ptr->GetBounds(), entity_ptr->collisionCategory, isTerrain };
+}
+
+// Requests the creation of an object at the end of the tick. With onlyIntoEmptyCell the object is not created when
+// its cell is already solid by then (e.g. two blocks of ice filling the same hole).
+void EntityManager::Spawn(EntityIdentificator entity_id, int x, int y, bool onlyIntoEmptyCell) {
+  spawnCommands.push_back({ entity_id, x, y, onlyIntoEmptyCell });
+}
+
+// Requests the deletion of an object at the end of the tick. It is no longer updated meanwhile.
+void EntityManager::Despawn(IEntity* entity_ptr) {
+  if (!entity_ptr->isMarkedToDelete) {
+    entity_ptr->isMarkedToDelete = true;
+    objectsToDelete.push_back(entity_ptr);
+  }
+}
+
+// Creates the objects requested during the tick, once every object is updated, and inserts them into the broadphase
+// in one batch. Objects requested by the initial update of a new object are created too.
+void EntityManager::applySpawnCommands() {
+  spawnInsertions.clear();
+  for (size_t k = 0; k < spawnCommands.size(); k++) {
+    SpawnCommand command = spawnCommands[k];
+    if (command.onlyIntoEmptyCell && terrainGrid.IsSolid(command.x, command.y)) {
+      continue;
+    }
+
+    if (std::optional<IEntity *> entity_ptr = createEntity(command.entity_id, command.x, command.y, true)) {
+      spawnInsertions.push_back(broadphaseInsertion(*entity_ptr));
+    }
+  }
+  spawnCommands.clear();
+
+  if (!spawnInsertions.empty()) {
+    broadphase->InsertBatch(spawnInsertions);
+  }
+}
+
 void EntityManager::PlayerReachedNewAltitude(int cellY) {
   if ((std::find(validAltitudes.begin(), validAltitudes.end(), cellY) != validAltitudes.end()) || (cellY <= BONUS_STAGE_CELL_Y)) {
     float padding_top = (cellY != BONUS_STAGE_CELL_Y) ? CAMERA_PADDING_TOP : CAMERA_BONUS_STAGE_PADDING_TOP;
@@ -67,69 +222,237 @@ void EntityManager::PlayerEnteredBonusStage() {
   // TODO
 }
 
-std::optional<float> EntityManager::Update(uint8_t pressedKeys) {
+// Called when a cached terrain object starts changing (e.g. a brick hit by the player), so it is drawn as an
+// individual sprite from now on and its chunk is redrawn without it.
+void EntityManager::RemoveFromTerrainCache(IEntity* entity_ptr) {
+  if (entity_ptr->isCachedTerrain) {
+    entity_ptr->isCachedTerrain = false;
+    terrainChunkVersions[entity_ptr->position.GetInitialCellY() / TERRAIN_CHUNK_ROWS]++;
+  }
+}
+
+// Called when a brick stops being solid ground (e.g. hit by the player) or is deleted.
+void EntityManager::RemoveFromTerrainGrid(IEntity* entity_ptr) {
+  terrainGrid.Clear(entity_ptr->position.GetInitialCellX(), entity_ptr->position.GetInitialCellY(), entity_ptr->handle);
+}
+
+const TerrainGrid& EntityManager::GetTerrainGrid() {
+  return terrainGrid;
+}
+
+Broadphase* EntityManager::GetBroadphase() {
+  return broadphase;
+}
+
+uint64_t EntityManager::GetTick() {
+  return tick;
+}
+
+uint64_t EntityManager::ScheduleAnimationWakeUp(IEntity* entity_ptr, uint64_t pendingTick, uint64_t dueTick) {
+  return animationScheduler.Schedule(entity_ptr, pendingTick, dueTick);
+}
+
+void EntityManager::CancelAnimationWakeUp(IEntity* entity_ptr, uint64_t pendingTick) {
+  animationScheduler.Cancel(entity_ptr, pendingTick);
+}
+
+const BroadphasePairs* EntityManager::GetBroadphasePairs() {
+  return broadphasePairs;
+}
+
+// Candidates of the actor overlapping the given bounds, taken from the pairs of the tick.
+void EntityManager::QueryCollisions(IEntity* entity_ptr, const aabb::Bounds2i& bounds, std::vector<aabb::AABBIntersection<IEntity*>>& intersections) {
+  broadphasePairs->Query(entity_ptr, bounds, intersections);
+}
+
+// Hands the current sprite of a broken object over to the debris pool, which propels it from the object position and
+// goes on with the given frame of its animation when nextFrameTick is reached. The object is deleted at the end of the tick.
+void EntityManager::SpawnDebris(IEntity* entity_ptr, const AnimationTable& animationTable, uint32_t animation, uint32_t frame,
+                                uint64_t nextFrameTick, float vSpeed, float hSpeed) {
+  Rectangle src = { entity_ptr->currentSprite.u1, entity_ptr->currentSprite.v1, entity_ptr->currentSprite.u2, entity_ptr->currentSprite.v2 };
+  debris.Spawn(animationTable, animation, frame, nextFrameTick, src, entity_ptr->boundingBox, entity_ptr->position.GetRealX(), entity_ptr->position.GetRealY(), vSpeed, hSpeed);
+  Despawn(entity_ptr);
+}
+
+const DebrisPool& EntityManager::GetDebris() {
+  return debris;
+}
+
+// Applies the key events received since the previous tick. A key pressed and released within the same tick is
+// still reported as pressed for this tick, so short taps are not lost.
+uint8_t EntityManager::drainInputQueue() {
+  uint8_t tappedKeys = IC_KEY_NONE;
+  KeyEvent event;
+
+  while (inputQueue->pop(event)) {
+    if (event.pressed) {
+      heldKeys |= event.key;
+      tappedKeys |= event.key;
+    } else {
+      heldKeys &= ~event.key;
+    }
+    inputLatency = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - event.timestamp).count();
+  }
+
+  return heldKeys | tappedKeys;
+}
+
+std::optional<float> EntityManager::Update() {
+  std::optional<float> cameraPosition = std::nullopt;
+
+  tick++;
+  uint8_t pressedKeys = drainInputQueue();
+  updateBroadphasePairs();
   updateMobileObjects(pressedKeys);
   updateStaticObjects();
-  updateSpriteRectBuffers();
-  deleteUneededObjects();
+  debris.Update(tick);
+  applySpawnCommands();
 
   // Update vertical camera position when player reaches new level height
+  previousCameraPosition = currentCameraPosition;
   if (newCameraPosition < currentCameraPosition) {
     currentCameraPosition -= CAMERA_SPEED; // Progressive update to get an smooth transition
-    return currentCameraPosition;
+    cameraPosition = currentCameraPosition;
   }
 
-  return std::nullopt;
+  streamBands();
+  updateSpriteRectBuffers();
+  deleteUneededObjects();
+
+  // The terrain of the bands is bulk built again once the deleted bands are out of the broadphase
+  if (terrainBuildIsDue) {
+    broadphase->BuildTerrain();
+    terrainBuildIsDue = false;
+  }
+
+  return cameraPosition;
+}
+
+// Selects the band of map rows covered by the camera plus a margin. Static objects never move (broken bricks are
+// handed over to the debris pool), so they can be culled by the row they were created in.
+void EntityManager::updateVisibleRows() {
+  int cameraRow = static_cast<int>(currentCameraPosition) / CELL_HEIGHT;
+  currentRow = std::clamp(cameraRow - CULLING_MARGIN_ROWS, 0, map_rows - 1);
+}
+
+// Appends the current sprite of the object to the frame. Returns false when the frame is full.
+bool EntityManager::pushSpriteRect(SpriteRectFrame& frame, uint32_t& i, IEntity* entity_ptr, Color tint) {
+  if (i >= spriteRectTripleBuffer->max_length) {
+    return false;
+  }
+
+  Rectangle src = { entity_ptr->currentSprite.u1, entity_ptr->currentSprite.v1, entity_ptr->currentSprite.u2, entity_ptr->currentSprite.v2 };
+  Vector2 pos = { entity_ptr->position.GetX(), entity_ptr->position.GetY() };
+  Vector2 prevPos = previousRenderPosition(entity_ptr);
+  Boundaries boundaries = entity_ptr->GetAbsoluteBoundaries();
+  frame.sprites[i++] = SpriteRect(src, pos, prevPos, boundaries, tint);
+  return true;
 }
 
 void EntityManager::updateSpriteRectBuffers() {
-  int i = 0;
-  std::vector<aabb::AABBIntersection<IEntity*>> objectIntersections = spacePartitionObjectsTree->query(player->GetLowerBound(), player->GetUpperBound());
+  uint32_t i = 0;
+  SpriteRectFrame& frame = spriteRectTripleBuffer->producerFrame();
+  playerIntersections.clear();
+  QueryCollisions(player, player->GetBounds(), playerIntersections);
 
-  for (auto const& x : staticObjects) {
-    IEntity* entity_ptr = x.second;
-    Rectangle src = { entity_ptr->currentSprite.u1, entity_ptr->currentSprite.v1, entity_ptr->currentSprite.u2, entity_ptr->currentSprite.v2 };
-    Vector2 pos = { entity_ptr->position.GetX(), entity_ptr->position.GetY() };
-    Boundaries boundaries = entity_ptr->GetAbsoluteBoundaries();
-    Boundaries solidBoundaries = entity_ptr->GetAbsoluteSolidBoundaries();
-    Color tint = WHITE;
+  updateVisibleRows();
+  uint32_t lastRow = std::min(currentRow + visibleRows, static_cast<uint32_t>(map_rows));
+  float bandTop = currentRow * CELL_HEIGHT_FLOAT;
+  float bandBottom = lastRow * CELL_HEIGHT_FLOAT;
 
-    // Tint in RED those objects that are candidates to collide with the player object.
-    auto it = std::find_if(objectIntersections.begin(), objectIntersections.end(),
-                           [entity_ptr](const aabb::AABBIntersection<IEntity*>& intersection) {
-                               return intersection.particle == entity_ptr;
-                           });
+  // Cached terrain first, grouped by chunk. The sprites of a chunk are sent when it changes or becomes visible, until
+  // the render thread takes one of the frames holding them (it may skip some); afterwards only the chunk is sent.
+  uint32_t firstChunk = currentRow / TERRAIN_CHUNK_ROWS;
+  uint32_t lastChunk = (lastRow - 1) / TERRAIN_CHUNK_ROWS;
+  uint64_t consumedTick = spriteRectTripleBuffer->consumedTick();
+  frame.terrainChunkCount = 0;
+  for (uint32_t chunk = firstChunk; chunk <= lastChunk; chunk++) {
+    if (chunk < firstSentChunk || chunk > lastSentChunk || terrainChunkSentVersions[chunk] != terrainChunkVersions[chunk]) {
+      terrainChunkSentVersions[chunk] = terrainChunkVersions[chunk];
+      terrainChunkSentTicks[chunk] = tick;
+    }
 
-    if (it != objectIntersections.end()) {
-      tint = RED;
+    TerrainChunkRef chunkRef = { chunk, terrainChunkVersions[chunk], i, 0, consumedTick < terrainChunkSentTicks[chunk] };
+    if (chunkRef.hasSprites) {
+      uint32_t chunkLastRow = std::min((chunk + 1) * TERRAIN_CHUNK_ROWS, static_cast<uint32_t>(map_rows));
+      for (uint32_t row = chunk * TERRAIN_CHUNK_ROWS; row < chunkLastRow; row++) {
+        for (IEntity* entity_ptr : staticObjectsByRow[row]) {
+          if (entity_ptr->isCachedTerrain) pushSpriteRect(frame, i, entity_ptr, WHITE);
+        }
+      }
     }
 
-    spriteRectDoubleBuffer->producer_buffer[i++] = SpriteRect(src, pos, boundaries, tint);
+    chunkRef.spriteCount = i - chunkRef.firstSprite;
+    frame.terrainChunks[frame.terrainChunkCount++] = chunkRef;
   }
+  firstSentChunk = firstChunk;
+  lastSentChunk = lastChunk;
+  frame.firstDynamicSprite = i;
+
+  for (uint32_t row = currentRow; row < lastRow; row++) {
+    for (IEntity* entity_ptr : staticObjectsByRow[row]) {
+      if (entity_ptr->isMarkedToDelete) continue;
 
-  for (auto const& x : mobileObjects) {
-    IEntity* entity_ptr = x.second;
-    Rectangle src = { entity_ptr->currentSprite.u1, entity_ptr->currentSprite.v1, entity_ptr->currentSprite.u2, entity_ptr->currentSprite.v2 };
-    Vector2 pos = { entity_ptr->position.GetX(), entity_ptr->position.GetY() };
-    Boundaries boundaries = entity_ptr->GetAbsoluteBoundaries();
-    Boundaries solidBoundaries = entity_ptr->GetAbsoluteSolidBoundaries();
-    spriteRectDoubleBuffer->producer_buffer[i] = SpriteRect(src, pos, boundaries, WHITE);
-    i++;
+      // Tint in RED those objects that are candidates to collide with the player object. Cached terrain is drawn
+      // again on top of its chunk to show the tint.
+      auto it = std::find_if(playerIntersections.begin(), playerIntersections.end(),
+                             [entity_ptr](const aabb::AABBIntersection<IEntity*>& intersection) {
+                                 return intersection.particle == entity_ptr;
+                             });
+
+      if (it != playerIntersections.end()) {
+        pushSpriteRect(frame, i, entity_ptr, RED);
+      } else if (!entity_ptr->isCachedTerrain) {
+        pushSpriteRect(frame, i, entity_ptr, WHITE);
+      }
+    }
   }
 
-  spriteRectDoubleBuffer->producer_buffer_length = i;
-  spriteRectDoubleBuffer->swapBuffers();
+  // Debris keeps falling past the bottom of the map, so it is culled by the band of the camera instead
+  debris.PushSpriteRects(frame, i, spriteRectTripleBuffer->max_length, bandTop, (currentRow + visibleRows) * CELL_HEIGHT_FLOAT);
+
+  for (IEntity* entity_ptr : objects) {
+    if (entity_ptr->Type() == EntityType::TERRAIN) continue;
+
+    // Skip the mobile objects out of the visible band
+    float y = entity_ptr->position.GetY();
+    if (y + std::abs(entity_ptr->currentSprite.v2) < bandTop || y > bandBottom) continue;
+
+    pushSpriteRect(frame, i, entity_ptr, WHITE);
+  }
+
+  frame.length = i;
+  frame.tick = tick;
+  frame.inputLatency = inputLatency;
+  frame.cameraPosition = currentCameraPosition;
+  frame.previousCameraPosition = previousCameraPosition;
+  spriteRectTripleBuffer->publish();
 }
 
-void EntityManager::updateEntities(std::map<uint32_t, IEntity*>& objects, std::optional<uint8_t> pressedKeys = std::nullopt) {
-    for (auto const& x : objects) {
-        IEntity* entity_ptr = x.second;
+Vector2 EntityManager::previousRenderPosition(IEntity* entity_ptr) {
+  float x = entity_ptr->position.GetX();
+  float y = entity_ptr->position.GetY();
+  float prevX = entity_ptr->position.GetPreviousX();
+  float prevY = entity_ptr->position.GetPreviousY();
+
+  // Objects that jumped this tick (e.g. clouds wrapping around the level) are drawn at their new position.
+  if (std::abs(x - prevX) > INTERPOLATION_SNAP_DISTANCE || std::abs(y - prevY) > INTERPOLATION_SNAP_DISTANCE) {
+    return { x, y };
+  }
 
-        if (entity_ptr->isMarkedToDelete) {
-            objectsToDelete.push_back(entity_ptr);
+  return { prevX, prevY };
+}
+
+// Updates either the static (terrain) or the mobile objects. Objects are neither created nor deleted meanwhile, see
+// Spawn and Despawn. Objects only updated when their next sprite is due are left to the animation scheduler.
+void EntityManager::updateEntities(bool terrain, std::optional<uint8_t> pressedKeys = std::nullopt) {
+    for (IEntity* entity_ptr : objects) {
+        if ((entity_ptr->Type() == EntityType::TERRAIN) != terrain || entity_ptr->isMarkedToDelete || !entity_ptr->updatesEveryTick) {
             continue;
         }
 
+        entity_ptr->position.savePreviousXY();
+
         if (pressedKeys.has_value()) {
             entity_ptr->Update(pressedKeys.value());
         } else {
@@ -138,31 +461,81 @@ void EntityManager::updateEntities(std::map<uint32_t, IEntity*>& objects, std::o
     }
 }
 
+// Broadphase pass of the tick: every actor (player and enemies) gathers its collision candidates once. Its bounds are
+// merged with its solid bounds, which the player checks, and grown by the sweep margin of the pairs.
+void EntityManager::updateBroadphasePairs() {
+  broadphasePairs->Clear();
+
+  for (IEntity* entity_ptr : objects) {
+    if (entity_ptr->Type() == EntityType::TERRAIN || entity_ptr->isMarkedToDelete) continue;
+
+    aabb::Bounds2i bounds = entity_ptr->GetBounds();
+    aabb::Bounds2i solidBounds = entity_ptr->GetSolidBounds();
+    bounds = { std::min(bounds.lowerX, solidBounds.lowerX), std::min(bounds.lowerY, solidBounds.lowerY),
+               std::max(bounds.upperX, solidBounds.upperX), std::max(bounds.upperY, solidBounds.upperY) };
+    broadphasePairs->AddActor(entity_ptr, bounds);
+  }
+}
+
 void EntityManager::updateMobileObjects(uint8_t pressedKeys) {
-    updateEntities(mobileObjects, pressedKeys);
+    updateEntities(false, pressedKeys);
 }
 
 void EntityManager::updateStaticObjects() {
-    updateEntities(staticObjects);
+    updateEntities(true);
+
+    // Animated terrain, only when its next sprite is due
+    dueAnimations.clear();
+    animationScheduler.Advance(tick, dueAnimations);
+    for (IEntity* entity_ptr : dueAnimations) {
+        entity_ptr->animationWakeUpTick = 0;
+        if (!entity_ptr->isMarkedToDelete) {
+            entity_ptr->Update();
+        }
+    }
 }
 
 void EntityManager::deleteUneededObjects() {
+  EntityFactory* factory = EntityFactory::Get(this, textureManager, broadphase);
   for (auto entity_ptr : objectsToDelete) {
-    staticObjects.erase(entity_ptr->uniqueId);
-    mobileObjects.erase(entity_ptr->uniqueId);
-
-    // Objects are responsible for removing themselves from the space partition tree, so the
-    // following code is just for safety.
-    spacePartitionObjectsTree->removeParticle(entity_ptr);
-
-    delete entity_ptr;
+    if (entity_ptr->Type() == EntityType::TERRAIN) {
+      RemoveFromTerrainCache(entity_ptr);
+      std::vector<IEntity*>& row = staticObjectsByRow[entity_ptr->position.GetInitialCellY()];
+      row.erase(std::remove(row.begin(), row.end(), entity_ptr), row.end());
+      RemoveFromTerrainGrid(entity_ptr);
+    }
+    objects.Erase(entity_ptr->handle);
+    broadphase->Remove(entity_ptr);
+    animationScheduler.Cancel(entity_ptr, entity_ptr->animationWakeUpTick);
+    factory->DestroyEntity(entity_ptr);
   }
 
   objectsToDelete.clear();
 }
 
+std::optional<IEntity *> EntityManager::GetEntity(EntityHandle handle) {
+  return objects.Get(handle);
+}
+
+size_t EntityManager::GetObjectCount() {
+  return objects.Size();
+}
+
+bool EntityManager::IsLoaded() {
+  return loaded;
+}
+
 EntityManager::~EntityManager() {
-  if(spacePartitionObjectsTree != nullptr) {
-    delete spacePartitionObjectsTree;
+  EntityFactory* factory = EntityFactory::Get(this, textureManager, broadphase);
+  for (IEntity* entity_ptr : objects) {
+    factory->DestroyEntity(entity_ptr);
+  }
+
+  if(broadphasePairs != nullptr) {
+    delete broadphasePairs;
+  }
+
+  if(broadphase != nullptr) {
+    delete broadphase;
   }
 }
@@ -1,45 +1,44 @@
+#include <cstdio>
 #include <entity_sprite_sheet.h>
 
-EntitySpriteSheet::EntitySpriteSheet(EntityIdentificator _id)
-        : Id(_id)
+EntitySpriteSheet::EntitySpriteSheet(EntityIdentificator _id, const AnimationTable *_animationTable)
+        : Id(_id), animationTable(_animationTable)
 {
 
 }
 
 EntitySpriteSheet::~EntitySpriteSheet() {
-  std::map<uint16_t, EntitySpriteSheetAnimation*>::iterator it = animations.begin();
-
-	while (it != animations.end())
-	{
-		uint16_t entityAnimationId = it->first;
-		EntitySpriteSheetAnimation* entityAnimation = it->second;
-		delete entityAnimation;
-		it++;
-	}
 }
 
 void EntitySpriteSheet::Print()
 {
-  printf("Entity type Id: %d\n", Id);
-  printf("Total object actions: %lu\n", animations.size());
+  uint32_t totalAnimations = 0;
+  for (uint32_t animation : animationIndices) {
+    totalAnimations += (animation != NO_ANIMATION);
+  }
 
-  std::map<uint16_t, EntitySpriteSheetAnimation*>::iterator it = animations.begin();
+  printf("Entity type Id: %d\n", Id);
+  printf("Total object actions: %u\n", totalAnimations);
 
-	while (it != animations.end())
-	{
-		it->second->Print();
-		it++;
-	}
+  for (uint16_t animationId = 0; animationId < animationIndices.size(); animationId++) {
+    if (animationIndices[animationId] != NO_ANIMATION) {
+      printf("Sprite sheet animation Id: %d\n", animationId);
+      animationTable->Print(animationIndices[animationId]);
+    }
+  }
 }
 
-void EntitySpriteSheet::AddAnimation(EntitySpriteSheetAnimation *animation) {
-  animations.insert(std::pair<uint16_t,EntitySpriteSheetAnimation*>(animation->Id, animation));
+// Maps the animation id of the sprite sheet to the index of the animation in the table.
+void EntitySpriteSheet::AddAnimation(uint16_t animationId, uint32_t animation) {
+  if (animationId >= animationIndices.size()) {
+    animationIndices.resize(animationId + 1, NO_ANIMATION);
+  }
+  animationIndices[animationId] = animation;
 }
 
-std::optional<EntitySpriteSheetAnimation*> EntitySpriteSheet::GetAnimationWithId(uint16_t AnimationId) {
-    auto it = animations.find(AnimationId);
-    if (it != animations.end()) {
-        return it->second;
+std::optional<uint32_t> EntitySpriteSheet::GetAnimationWithId(uint16_t animationId) const {
+    if (animationId < animationIndices.size() && animationIndices[animationId] != NO_ANIMATION) {
+        return animationIndices[animationId];
     }
 
     return std::nullopt;
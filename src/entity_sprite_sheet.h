@@ -1,7 +1,7 @@
 #ifndef ENTITY_SPRITE_SHEET_H
 #define ENTITY_SPRITE_SHEET_H
 
-#include <map>
+#include <vector>
 #include <optional>
 #include <defines.h>
 #include <entity_sprite_sheet_animation.h>
@@ -10,12 +10,16 @@
 class EntitySpriteSheet
 {
         EntityIdentificator Id;
-        std::map<uint16_t, EntitySpriteSheetAnimation*> animations;
+        const AnimationTable *animationTable;
+        std::vector<uint32_t> animationIndices; // Index in the animation table by animation id, NO_ANIMATION when missing
 public:
-        EntitySpriteSheet(EntityIdentificator);
+        static constexpr uint32_t NO_ANIMATION = UINT32_MAX;
+
+        EntitySpriteSheet(EntityIdentificator, const AnimationTable*);
         ~EntitySpriteSheet();
-        void AddAnimation(EntitySpriteSheetAnimation*);
-        std::optional<EntitySpriteSheetAnimation*> GetAnimationWithId(uint16_t);
+        void AddAnimation(uint16_t, uint32_t);
+        std::optional<uint32_t> GetAnimationWithId(uint16_t) const;
+        const AnimationTable& GetAnimationTable() const { return *animationTable; }
         void Print();
 };
 
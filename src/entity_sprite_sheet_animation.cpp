@@ -1,32 +1,20 @@
 #include <iostream>
 #include <entity_sprite_sheet_animation.h>
 
-EntitySpriteSheetAnimation::EntitySpriteSheetAnimation(uint16_t _id)
-        : Id(_id)
+SpriteData AnimationTable::GetSprite(uint32_t animation, uint32_t frame) const
 {
-
-}
-
-EntitySpriteSheetAnimation::~EntitySpriteSheetAnimation() {
-  sprites.clear();
+  const AssetFrame& sprite = tables.frames[tables.animations[animation].firstFrame + frame];
+  SpriteAreaRange areas = { sprite.firstArea, static_cast<uint16_t>(sprite.solidAreaCount), static_cast<uint16_t>(sprite.simpleAreaCount) };
+  return { sprite.width, sprite.height, sprite.xOffset, sprite.yOffset, sprite.u1, sprite.v1, sprite.u2, sprite.v2, sprite.durationTicks, false,
+           sprite.lowerBoundX, sprite.lowerBoundY, sprite.upperBoundX, sprite.upperBoundY, areas };
 }
 
-void EntitySpriteSheetAnimation::Print()
+void AnimationTable::Print(uint32_t animation) const
 {
-  printf("Sprite sheet animation Id: %d\n", Id);
-  printf("Total animation frames: %lu\n", sprites.size());
-  for (auto sprite : sprites)
+  printf("Total animation frames: %u\n", GetSpriteCount(animation));
+  for (uint32_t k = 0; k < GetSpriteCount(animation); k++)
   {
+    SpriteData sprite = GetSprite(animation, k);
     printf("W: %d H: %d x: %d y: %d u1: %f v1: %f u2: %f v2: %f\n", sprite.width, sprite.height, sprite.xOffset, sprite.yOffset, sprite.u1, sprite.v1, sprite.u2, sprite.v2);
   }
 }
-
-void EntitySpriteSheetAnimation::AddSprite(SpriteData sprite)
-{
-  sprites.push_back(sprite);
-}
-
-const std::vector<SpriteData>& EntitySpriteSheetAnimation::GetSprites() const
-{
-  return sprites;
-}
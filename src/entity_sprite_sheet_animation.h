@@ -4,18 +4,24 @@
 #include <vector>
 #include <defines.h>
 #include <sprite.h>
+#include <asset_cache.h>
 
-struct SpriteData { int width, height, xOffset, yOffset; float u1, v1, u2, v2; int duration; bool beginNewLoop; int lowerBoundX, lowerBoundY, upperBoundX, upperBoundY; SpriteAreas *areas; };
+struct SpriteData { int width, height, xOffset, yOffset; float u1, v1, u2, v2; int durationTicks; bool beginNewLoop; int lowerBoundX, lowerBoundY, upperBoundX, upperBoundY; SpriteAreaRange areas; };
 
-class EntitySpriteSheetAnimation
+// Frames of every animation of every sprite sheet, viewed in place in the compiled entity types (see asset_cache.h),
+// which must outlive the table. An animation is a range of the frame table identified by a dense index, so an object
+// only keeps the index of its animation and frame. The collision areas of all the frames share one more array,
+// referenced by range from each frame.
+class AnimationTable
 {
-  std::vector<SpriteData> sprites;
+  AssetTables tables;
 public:
-  uint16_t Id;
-  EntitySpriteSheetAnimation(uint16_t);
-  ~EntitySpriteSheetAnimation();
-  void AddSprite(SpriteData);
-  const std::vector<SpriteData>& GetSprites() const;
-  void Print();
+  void View(const AssetTables& _tables) { tables = _tables; }
+  uint32_t GetAnimationCount() const { return tables.animationCount; }
+  const SpriteArea* GetSolidAreas(const SpriteAreaRange& range) const { return tables.areas + range.first; }
+  const SpriteArea* GetSimpleAreas(const SpriteAreaRange& range) const { return tables.areas + range.first + range.solidCount; }
+  SpriteData GetSprite(uint32_t animation, uint32_t frame) const;
+  uint32_t GetSpriteCount(uint32_t animation) const { return tables.animations[animation].frameCount; }
+  void Print(uint32_t animation) const;
 };
 #endif
@@ -0,0 +1,25 @@
+#include <input_queue.h>
+
+bool InputQueue::push(uint8_t key, bool pressed)
+{
+        uint32_t currentTail = tail.load(std::memory_order_relaxed);
+        if (currentTail - head.load(std::memory_order_acquire) == CAPACITY) {
+                return false; // Full. The logic thread is stalled, so the event would be stale anyway.
+        }
+
+        events[currentTail & (CAPACITY - 1)] = { key, pressed, std::chrono::steady_clock::now() };
+        tail.store(currentTail + 1, std::memory_order_release);
+        return true;
+}
+
+bool InputQueue::pop(KeyEvent& event)
+{
+        uint32_t currentHead = head.load(std::memory_order_relaxed);
+        if (currentHead == tail.load(std::memory_order_acquire)) {
+                return false;
+        }
+
+        event = events[currentHead & (CAPACITY - 1)];
+        head.store(currentHead + 1, std::memory_order_release);
+        return true;
+}
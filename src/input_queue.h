@@ -0,0 +1,29 @@
+#ifndef INPUT_QUEUE_H
+#define INPUT_QUEUE_H
+
+#include <atomic>
+#include <chrono>
+#include <defines.h>
+
+// A key press or release as captured by the render thread.
+struct KeyEvent {
+  uint8_t key;      // KeyboardKeyCode
+  bool pressed;     // False when the key has been released
+  std::chrono::steady_clock::time_point timestamp;
+};
+
+// Lock-free single producer / single consumer ring of key events. The render thread pushes the events as they are
+// polled and the game logic thread drains them at the beginning of every tick.
+class InputQueue {
+  static constexpr uint32_t CAPACITY = 256; // Must be a power of two
+
+  KeyEvent events[CAPACITY];
+  std::atomic<uint32_t> head{0}; // Next event to pop, written by the consumer
+  std::atomic<uint32_t> tail{0}; // Next free slot, written by the producer
+
+public:
+  bool push(uint8_t, bool);
+  bool pop(KeyEvent&);
+};
+
+#endif
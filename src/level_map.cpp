@@ -0,0 +1,171 @@
+#include <level_map.h>
+#include <asset_cache.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+static const char LEVEL_MAP_MAGIC[8] = { 'I', 'C', 'L', 'E', 'V', 'E', 'L', '\0' };
+
+// Binary file of a text map: same path with the .bin extension.
+std::string LevelMap::CacheFilename(const std::string& filename) {
+  size_t dot = filename.find_last_of('.');
+  size_t slash = filename.find_last_of('/');
+  bool hasExtension = dot != std::string::npos && (slash == std::string::npos || dot > slash);
+  return (hasExtension ? filename.substr(0, dot) : filename) + ".bin";
+}
+
+// Reads the binary file, or compiles the text file when the binary file is missing or stale and writes it aside.
+bool LevelMap::Load(const std::string& filename, const std::string& cacheFilename, uint32_t bandRows) {
+  loadedFromCache = Read(cacheFilename, filename, bandRows);
+  if (loadedFromCache) {
+    return true;
+  }
+
+  if (!Compile(filename, bandRows)) {
+    data.clear();
+    return false;
+  }
+
+  // A map that cannot be cached is still usable
+  std::string temporaryFilename = cacheFilename + ".tmp";
+  if (FILE *file = std::fopen(temporaryFilename.c_str(), "wb")) {
+    bool written = std::fwrite(data.data(), data.size(), 1, file) == 1;
+    written = (std::fclose(file) == 0) && written;
+    if (!written || std::rename(temporaryFilename.c_str(), cacheFilename.c_str()) != 0) {
+      std::remove(temporaryFilename.c_str());
+    }
+  }
+  return true;
+}
+
+bool LevelMap::Read(const std::string& cacheFilename, const std::string& filename, uint32_t bandRows) {
+  std::ifstream infile(cacheFilename, std::ios::binary);
+  if (!infile) {
+    return false;
+  }
+  data.assign(std::istreambuf_iterator<char>(infile), std::istreambuf_iterator<char>());
+
+  if (data.size() < sizeof(LevelMapHeader)) {
+    data.clear();
+    return false;
+  }
+
+  // The binary file can be shipped without the text file. When both exist, it must come from the current text file.
+  int64_t sourceTime = 0;
+  uint64_t sourceSize = 0;
+  bool hasSource = AssetFileStatus(filename, sourceTime, sourceSize);
+
+  const LevelMapHeader& header = Header();
+  size_t expectedSize = sizeof(LevelMapHeader) + (static_cast<size_t>(header.bandCount) + 1) * sizeof(uint32_t) +
+                        static_cast<size_t>(header.cellCount) * sizeof(LevelCell);
+  bool valid = std::memcmp(header.magic, LEVEL_MAP_MAGIC, sizeof(header.magic)) == 0 &&
+               header.version == LEVEL_MAP_VERSION &&
+               bandRows != 0 && header.bandRows == bandRows &&
+               (!hasSource || (header.sourceSize == sourceSize && header.sourceModificationTime == sourceTime)) &&
+               expectedSize == data.size() &&
+               header.checksum == AssetChecksum(data.data() + sizeof(LevelMapHeader), data.size() - sizeof(LevelMapHeader)) &&
+               header.bandCount == (header.rows + bandRows - 1) / bandRows &&
+               BandIndex()[header.bandCount] == header.cellCount;
+
+  // Every cell must lie in the map, as the objects are indexed by their cell
+  for (uint32_t band = 0; valid && band < header.bandCount; band++) {
+    valid = BandIndex()[band] <= BandIndex()[band + 1];
+    for (const LevelCell* cell = BandBegin(band); valid && cell != BandEnd(band); cell++) {
+      valid = cell->column < header.columns && cell->row < bandRows && band * bandRows + cell->row < header.rows;
+    }
+  }
+
+  if (!valid) {
+    data.clear();
+  }
+  return valid;
+}
+
+// Every line holds the cells of a map row. Empty lines and anything after // are ignored. Every row must have the
+// same number of cells.
+bool LevelMap::Compile(const std::string& filename, uint32_t bandRows) {
+  std::ifstream infile(filename);
+  if (!infile || bandRows == 0) {
+    return false;
+  }
+
+  std::vector<uint16_t> map;
+  uint32_t columns = 0;
+  uint32_t rows = 0;
+  std::string line;
+  while (std::getline(infile, line)) {
+    size_t comment = line.find("//");
+    if (comment != std::string::npos) {
+      line.erase(comment);
+    }
+
+    uint32_t rowColumns = 0;
+    const char *cursor = line.c_str();
+    while (true) {
+      char *end;
+      long entityId = std::strtol(cursor, &end, 10);
+      if (end == cursor) break;
+      if (entityId < 0 || entityId > UINT16_MAX) {
+        return false;
+      }
+      map.push_back(static_cast<uint16_t>(entityId));
+      rowColumns++;
+      cursor = end;
+    }
+
+    // Anything left on the line is not a cell
+    if (line.find_first_not_of(" \t\r", cursor - line.c_str()) != std::string::npos) {
+      return false;
+    }
+    if (rowColumns == 0) {
+      continue;
+    }
+    if (rows == 0) {
+      columns = rowColumns;
+    }
+    if (rowColumns != columns || columns > UINT8_MAX + 1) {
+      return false;
+    }
+    rows++;
+  }
+
+  LevelMapHeader header = {};
+  std::memcpy(header.magic, LEVEL_MAP_MAGIC, sizeof(header.magic));
+  header.version = LEVEL_MAP_VERSION;
+  if (!AssetFileStatus(filename, header.sourceModificationTime, header.sourceSize)) {
+    return false;
+  }
+  header.columns = columns;
+  header.rows = rows;
+  header.bandRows = bandRows;
+  header.bandCount = (rows + bandRows - 1) / bandRows;
+
+  std::vector<uint32_t> bandIndex;
+  std::vector<LevelCell> cells;
+  for (uint32_t band = 0; band < header.bandCount; band++) {
+    bandIndex.push_back(static_cast<uint32_t>(cells.size()));
+    for (uint32_t row = band * bandRows; row < std::min(rows, (band + 1) * bandRows); row++) {
+      for (uint32_t column = 0; column < columns; column++) {
+        if (uint16_t entityId = map[row * columns + column]) {
+          cells.push_back({ static_cast<uint8_t>(column), static_cast<uint8_t>(row - band * bandRows), entityId });
+        }
+      }
+    }
+  }
+  bandIndex.push_back(static_cast<uint32_t>(cells.size()));
+  header.cellCount = static_cast<uint32_t>(cells.size());
+
+  const uint8_t *headerBytes = reinterpret_cast<const uint8_t*>(&header);
+  const uint8_t *indexBytes = reinterpret_cast<const uint8_t*>(bandIndex.data());
+  const uint8_t *cellBytes = reinterpret_cast<const uint8_t*>(cells.data());
+  data.assign(headerBytes, headerBytes + sizeof(header));
+  data.insert(data.end(), indexBytes, indexBytes + bandIndex.size() * sizeof(uint32_t));
+  data.insert(data.end(), cellBytes, cellBytes + cells.size() * sizeof(LevelCell));
+
+  LevelMapHeader& storedHeader = *reinterpret_cast<LevelMapHeader*>(data.data());
+  storedHeader.checksum = AssetChecksum(data.data() + sizeof(LevelMapHeader), data.size() - sizeof(LevelMapHeader));
+  return true;
+}
@@ -0,0 +1,50 @@
+#ifndef LEVEL_MAP_H
+#define LEVEL_MAP_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Mountain map split in bands of rows (one level each), so the objects of a band can be created when the camera gets
+// close to it. The text file has one line per map row with the EntityIdentificator of every cell (0 when empty). It is
+// compiled into a binary file: a header, the index of the first cell of every band and the non empty cells, sorted by
+// band. The binary file is used as is, and rebuilt when the text file changes.
+constexpr uint32_t LEVEL_MAP_VERSION = 2;
+
+struct LevelCell { uint8_t column, row; uint16_t entityId; }; // Row inside the band
+
+struct LevelMapHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t checksum;         // FNV-1a of everything after the header
+  uint64_t sourceSize;       // Text file the map was compiled from
+  int64_t sourceModificationTime; // Nanoseconds
+  uint32_t columns, rows, bandRows, bandCount, cellCount;
+  uint32_t reserved;
+};
+
+class LevelMap {
+  std::vector<uint8_t> data; // Contents of the binary file
+  bool loadedFromCache = false;
+
+  const LevelMapHeader& Header() const { return *reinterpret_cast<const LevelMapHeader*>(data.data()); }
+  const uint32_t* BandIndex() const { return reinterpret_cast<const uint32_t*>(data.data() + sizeof(LevelMapHeader)); }
+  const LevelCell* Cells() const { return reinterpret_cast<const LevelCell*>(BandIndex() + Header().bandCount + 1); }
+  bool Compile(const std::string&, uint32_t);
+  bool Read(const std::string&, const std::string&, uint32_t);
+
+public:
+  bool Load(const std::string&, const std::string&, uint32_t);
+  static std::string CacheFilename(const std::string&);
+
+  int Columns() const { return data.empty() ? 0 : Header().columns; }
+  int Rows() const { return data.empty() ? 0 : Header().rows; }
+  int BandRows() const { return data.empty() ? 0 : Header().bandRows; }
+  int BandCount() const { return data.empty() ? 0 : Header().bandCount; }
+  const LevelCell* BandBegin(int band) const { return Cells() + BandIndex()[band]; }
+  const LevelCell* BandEnd(int band) const { return Cells() + BandIndex()[band + 1]; }
+  bool LoadedFromCache() const { return loadedFromCache; }
+};
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef OBJECT_POOL_H
+#define OBJECT_POOL_H
+
+#include <new>
+#include <vector>
+#include <cstdint>
+#include <type_traits>
+
+// Fixed capacity storage for objects of one concrete type. Acquire constructs a fresh object in a free slot and
+// Release destroys it and gives the slot back, so objects created and deleted over and over never reach the heap.
+// Acquire returns nullptr when every slot is in use.
+template <class T>
+class ObjectPool {
+  typedef typename std::aligned_storage<sizeof(T), alignof(T)>::type Storage;
+
+  std::vector<Storage> slots;
+  std::vector<uint32_t> freeSlots; // Used as a stack, so the most recently released slot (still in cache) is reused
+
+public:
+  explicit ObjectPool(uint32_t capacity) : slots(capacity) {
+    freeSlots.reserve(capacity);
+    for (uint32_t k = capacity; k > 0; k--) {
+      freeSlots.push_back(k - 1);
+    }
+  }
+
+  // Objects still in use are destroyed with the pool
+  ~ObjectPool() {
+    std::vector<bool> isFree(slots.size(), false);
+    for (uint32_t slot : freeSlots) {
+      isFree[slot] = true;
+    }
+    for (uint32_t slot = 0; slot < slots.size(); slot++) {
+      if (!isFree[slot]) {
+        reinterpret_cast<T*>(&slots[slot])->~T();
+      }
+    }
+  }
+
+  ObjectPool(const ObjectPool&) = delete;
+  ObjectPool& operator=(const ObjectPool&) = delete;
+
+  T* Acquire() {
+    if (freeSlots.empty()) {
+      return nullptr;
+    }
+
+    uint32_t slot = freeSlots.back();
+    freeSlots.pop_back();
+    return new (&slots[slot]) T();
+  }
+
+  bool Owns(const void* object) const {
+    const Storage* storage = static_cast<const Storage*>(object);
+    return storage >= slots.data() && storage < slots.data() + slots.size();
+  }
+
+  void Release(T* object) {
+    uint32_t slot = static_cast<uint32_t>(reinterpret_cast<Storage*>(object) - slots.data());
+    object->~T();
+    freeSlots.push_back(slot);
+  }
+
+  uint32_t Capacity() const { return static_cast<uint32_t>(slots.size()); }
+  uint32_t InUse() const { return Capacity() - static_cast<uint32_t>(freeSlots.size()); }
+};
+
+#endif
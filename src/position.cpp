@@ -5,6 +5,7 @@
 
 Position::Position() {
     initial_x = initial_y = x = y = 0.0f;
+    previous_x = previous_y = 0.0f;
     initial_int_x = initial_int_y = int_x = int_y = 0;
     int_x_offset = int_y_offset = 0;
 }
@@ -25,6 +26,14 @@ float Position::GetRealY() {
     return y;
 }
 
+float Position::GetPreviousX() {
+    return previous_x;
+}
+
+float Position::GetPreviousY() {
+    return previous_y;
+}
+
 int Position::GetIntX() {
     return int_x + int_x_offset;
 }
@@ -41,6 +50,14 @@ int Position::GetCellY() {
     return (int_y + (CELL_HEIGHT >> 1)) / CELL_HEIGHT;
 }
 
+int Position::GetInitialCellX() {
+    return initial_int_x / CELL_WIDTH;
+}
+
+int Position::GetInitialCellY() {
+    return initial_int_y / CELL_HEIGHT;
+}
+
 void Position::setOffset(int _x, int _y) {
     int_x_offset = _x;
     int_y_offset = _y;
@@ -52,6 +69,7 @@ void Position::setInitialXY(float _x, float _y) {
     initial_int_x = static_cast<int>(_x);
     initial_int_y = static_cast<int>(_y);
     setXY(_x, _y);
+    savePreviousXY(); // A new object must not be interpolated from the origin
 }
 
 void Position::setXY(float _x, float _y) {
@@ -88,6 +106,11 @@ void Position::recoverInitialPosition() {
     int_y = initial_int_y;
 }
 
+void Position::savePreviousXY() {
+    previous_x = GetX();
+    previous_y = GetY();
+}
+
 Position::~Position() {
 
 }
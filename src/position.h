@@ -7,6 +7,7 @@ class Position
 {
 private:
   float initial_x, initial_y, x, y;
+  float previous_x, previous_y; // Rendered position at the beginning of the current tick, used for interpolation
   int initial_int_x, initial_int_y, int_x, int_y, int_x_offset, int_y_offset;
 
 public:
@@ -16,10 +17,14 @@ class Position
   float GetRealX();
   float GetY();
   float GetRealY();
+  float GetPreviousX();
+  float GetPreviousY();
   int GetIntX();
   int GetIntY();
   int GetCellX();
   int GetCellY();
+  int GetInitialCellX();
+  int GetInitialCellY();
   void setInitialXY(float x, float y);
   void setOffset(int x, int y);
   void setXY(float, float);
@@ -30,6 +35,7 @@ class Position
   void addX(float);
   void addY(float);
   void recoverInitialPosition();
+  void savePreviousXY();
 };
 
 #endif
@@ -0,0 +1,87 @@
+#ifndef SLOT_MAP_H
+#define SLOT_MAP_H
+
+#include <vector>
+#include <optional>
+#include <cstdint>
+
+// Reference to a value stored in a SlotMap. The generation is bumped every time a slot is freed, so a handle to an
+// erased value never resolves again, even if the slot has been reused.
+struct EntityHandle {
+  uint32_t index = UINT32_MAX;
+  uint32_t generation = 0;
+
+  bool operator==(const EntityHandle& other) const { return index == other.index && generation == other.generation; }
+  bool operator!=(const EntityHandle& other) const { return !(*this == other); }
+};
+
+// Dense storage with O(1) insert, erase and handle lookup. Values are kept contiguous (erasing moves the last value
+// into the hole), so the iteration order is not stable across erases.
+template <class T>
+class SlotMap {
+  struct Slot {
+    uint32_t denseIndex; // Position of the value in the dense array, or next free slot when the slot is free
+    uint32_t generation;
+  };
+
+  std::vector<T> values;
+  std::vector<uint32_t> valueSlots; // Slot of every value of the dense array
+  std::vector<Slot> slots;
+  uint32_t freeSlot = UINT32_MAX;   // Head of the free slots list
+
+public:
+  EntityHandle Insert(const T& value) {
+    uint32_t slotIndex;
+    if (freeSlot != UINT32_MAX) {
+      slotIndex = freeSlot;
+      freeSlot = slots[slotIndex].denseIndex;
+    } else {
+      slotIndex = static_cast<uint32_t>(slots.size());
+      slots.push_back({ 0, 0 });
+    }
+
+    slots[slotIndex].denseIndex = static_cast<uint32_t>(values.size());
+    values.push_back(value);
+    valueSlots.push_back(slotIndex);
+    return { slotIndex, slots[slotIndex].generation };
+  }
+
+  bool Erase(EntityHandle handle) {
+    if (!Contains(handle)) {
+      return false;
+    }
+
+    uint32_t denseIndex = slots[handle.index].denseIndex;
+    uint32_t lastIndex = static_cast<uint32_t>(values.size()) - 1;
+    if (denseIndex != lastIndex) {
+      values[denseIndex] = values[lastIndex];
+      valueSlots[denseIndex] = valueSlots[lastIndex];
+      slots[valueSlots[denseIndex]].denseIndex = denseIndex;
+    }
+    values.pop_back();
+    valueSlots.pop_back();
+
+    slots[handle.index].generation++;
+    slots[handle.index].denseIndex = freeSlot;
+    freeSlot = handle.index;
+    return true;
+  }
+
+  bool Contains(EntityHandle handle) const {
+    return handle.index < slots.size() && slots[handle.index].generation == handle.generation;
+  }
+
+  std::optional<T> Get(EntityHandle handle) const {
+    if (!Contains(handle)) {
+      return std::nullopt;
+    }
+    return values[slots[handle.index].denseIndex];
+  }
+
+  size_t Size() const { return values.size(); }
+  T& operator[](size_t denseIndex) { return values[denseIndex]; }
+  typename std::vector<T>::iterator begin() { return values.begin(); }
+  typename std::vector<T>::iterator end() { return values.end(); }
+};
+
+#endif
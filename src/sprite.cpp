@@ -1,7 +1,7 @@
 #include <sprite.h>
 
 Sprite::Sprite() {
-        areas = nullptr;
+        areas = { 0, 0, 0 };
         width = 64;
         height = 64;
         u1 = 0.0f;
@@ -2,13 +2,16 @@
 #define SPRITE_H
 
 #include <vector>
+#include <cstdint>
 #include <defines.h>
-#include <collision/geometry/Rectangle.h>
+#include <asset_cache.h>
 
 using namespace std;
 
-struct Area { uint16_t id; collision::Rectangle rectangle; };
-struct SpriteAreas { std::vector<Area> solidAreas; std::vector<Area> simpleAreas; };
+// Collision area of a sprite, relative to the sprite origin. Solid areas stop the objects, simple areas only detect them.
+typedef AssetArea SpriteArea;
+// Areas of a sprite in the area table of the AnimationTable: the solid areas first, then the simple ones.
+struct SpriteAreaRange { uint32_t first; uint16_t solidCount, simpleCount; };
 
 class Sprite
 {
@@ -19,7 +22,7 @@ class Sprite
   int xOffset;
   int yOffset;
   float u1, v1, u2, v2;
-  SpriteAreas *areas; // DEPRECATED
+  SpriteAreaRange areas;
   Sprite();
   ~Sprite();
 };
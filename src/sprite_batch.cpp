@@ -0,0 +1,90 @@
+#include <cmath>
+#include <algorithm>
+#include <sprite_batch.h>
+
+// rlgl.h is not shipped in third_party/raylib. These are the rlgl entry points compiled into libraylib.a that the
+// batch needs (same signatures as rlgl.h).
+extern "C" {
+  void rlSetTexture(unsigned int id);
+  void rlBegin(int mode);
+  void rlEnd(void);
+  void rlColor4ub(unsigned char r, unsigned char g, unsigned char b, unsigned char a);
+  void rlTexCoord2f(float x, float y);
+  void rlVertex2f(float x, float y);
+  void rlNormal3f(float x, float y, float z);
+  bool rlCheckRenderBatchLimit(int vCount);
+}
+constexpr int RL_QUADS = 0x0007;
+
+SpriteBatch::SpriteBatch(Texture2D _texture, uint32_t maxSprites) {
+  texture = _texture;
+  vertices.reserve(maxSprites * 4);
+  texcoords.reserve(maxSprites * 4);
+  colors.reserve(maxSprites);
+}
+
+// Builds the quads of the frame sprites not drawn by the terrain cache, interpolated at the given alpha. The source rectangles follow the
+// DrawTextureRec conventions: a negative width or height flips the sprite.
+void SpriteBatch::Build(const SpriteRectFrame& frame, float alpha) {
+  float width = static_cast<float>(texture.width);
+  float height = static_cast<float>(texture.height);
+
+  vertices.clear();
+  texcoords.clear();
+  colors.clear();
+
+  for (uint32_t i = frame.firstDynamicSprite; i < frame.length; i++) {
+    const SpriteRect& sprite = frame.sprites[i];
+    Rectangle source = sprite.source;
+    float x = sprite.previousPosition.x + (sprite.position.x - sprite.previousPosition.x) * alpha;
+    float y = sprite.previousPosition.y + (sprite.position.y - sprite.previousPosition.y) * alpha;
+    float w = std::fabs(source.width);
+    float h = std::fabs(source.height);
+
+    float uLeft = source.x / width;
+    float uRight = (source.x + w) / width;
+    if (source.width < 0) std::swap(uLeft, uRight);
+    if (source.height < 0) source.y -= source.height;
+    float vTop = source.y / height;
+    float vBottom = (source.y + source.height) / height;
+
+    vertices.push_back({ x, y });
+    vertices.push_back({ x, y + h });
+    vertices.push_back({ x + w, y + h });
+    vertices.push_back({ x + w, y });
+    texcoords.push_back({ uLeft, vTop });
+    texcoords.push_back({ uLeft, vBottom });
+    texcoords.push_back({ uRight, vBottom });
+    texcoords.push_back({ uRight, vTop });
+    colors.push_back(sprite.tint);
+  }
+}
+
+void SpriteBatch::Draw() {
+  uint32_t quads = Size();
+
+  rlSetTexture(texture.id);
+  for (uint32_t first = 0; first < quads; first += QUADS_PER_SUBMIT) {
+    uint32_t last = std::min(quads, first + QUADS_PER_SUBMIT);
+
+    // Flushes the current rlgl batch beforehand if these quads do not fit in it
+    rlCheckRenderBatchLimit((last - first) * 4);
+
+    rlBegin(RL_QUADS);
+    rlNormal3f(0.0f, 0.0f, 1.0f);
+    for (uint32_t q = first; q < last; q++) {
+      const Color& color = colors[q];
+      rlColor4ub(color.r, color.g, color.b, color.a);
+      for (uint32_t v = q * 4; v < q * 4 + 4; v++) {
+        rlTexCoord2f(texcoords[v].x, texcoords[v].y);
+        rlVertex2f(vertices[v].x, vertices[v].y);
+      }
+    }
+    rlEnd();
+  }
+  rlSetTexture(0);
+}
+
+uint32_t SpriteBatch::Size() {
+  return colors.size();
+}
@@ -0,0 +1,25 @@
+#ifndef SPRITE_BATCH_H
+#define SPRITE_BATCH_H
+
+#include <vector>
+#include <raylib/raylib.h>
+#include <sprite_rect_triple_buffer.h>
+
+// Draws all the sprites of a frame as textured quads of a single texture atlas. The quads are built into flat
+// vertex/UV/color arrays and handed to rlgl in one batch, instead of going through one DrawTextureRec call per sprite.
+class SpriteBatch {
+  static constexpr uint32_t QUADS_PER_SUBMIT = 4096; // Below the default rlgl render batch size (8192 quads)
+
+  Texture2D texture;
+  std::vector<Vector2> vertices;   // 4 per quad: top-left, bottom-left, bottom-right, top-right
+  std::vector<Vector2> texcoords;  // 4 per quad, same order as vertices
+  std::vector<Color> colors;       // 1 per quad
+
+public:
+  SpriteBatch(Texture2D, uint32_t);
+  void Build(const SpriteRectFrame&, float);
+  void Draw();
+  uint32_t Size();
+};
+
+#endif
@@ -0,0 +1,51 @@
+#include <sprite_rect_triple_buffer.h>
+
+SpriteRectTripleBuffer::SpriteRectTripleBuffer(uint32_t _max_length) {
+        max_length = _max_length;
+        for (auto& frame : frames) {
+                frame.sprites = new SpriteRect[max_length];
+                frame.timestamp = std::chrono::steady_clock::now();
+        }
+}
+
+uint32_t SpriteRectTripleBuffer::buffer_size()
+{
+        return (3 * max_length * sizeof(SpriteRect));
+}
+
+SpriteRectFrame& SpriteRectTripleBuffer::producerFrame()
+{
+        return frames[producer_index];
+}
+
+void SpriteRectTripleBuffer::publish()
+{
+        frames[producer_index].timestamp = std::chrono::steady_clock::now();
+        uint8_t previous = middle_index.exchange(producer_index | FRESH_FRAME_FLAG, std::memory_order_acq_rel);
+        producer_index = previous & INDEX_MASK;
+}
+
+const SpriteRectFrame& SpriteRectTripleBuffer::consumerFrame()
+{
+        // Only the producer sets the flag, so if it is set now the exchange is guaranteed to return a fresh frame.
+        if (middle_index.load(std::memory_order_relaxed) & FRESH_FRAME_FLAG) {
+                uint8_t previous = middle_index.exchange(consumer_index, std::memory_order_acq_rel);
+                consumer_index = previous & INDEX_MASK;
+                consumed_tick.store(frames[consumer_index].tick, std::memory_order_release);
+        }
+        return frames[consumer_index];
+}
+
+// Tick of the last frame taken by the consumer. The frames published before it were either taken or skipped.
+uint64_t SpriteRectTripleBuffer::consumedTick()
+{
+        return consumed_tick.load(std::memory_order_acquire);
+}
+
+SpriteRectTripleBuffer::~SpriteRectTripleBuffer() {
+        for (auto& frame : frames) {
+                if(frame.sprites != nullptr) {
+                        delete[] frame.sprites;
+                }
+        }
+}
@@ -0,0 +1,71 @@
+#ifndef _SPRITE_RECT_TRIPLE_BUFFER_H
+#define _SPRITE_RECT_TRIPLE_BUFFER_H
+
+#include <atomic>
+#include <chrono>
+#include <defines.h>
+#include <entity.h>
+#include <raylib/raylib.h>
+
+struct SpriteRect {
+    Rectangle source;
+    Vector2 position;
+    Vector2 previousPosition; // Position at the previous tick. The render interpolates between both.
+    Boundaries boundaries; // Used only for debug purposes.
+    Color tint;  // Used only for debug purposes.
+
+    SpriteRect() : source({0,0,0,0}), position({0,0}), previousPosition({0,0}), boundaries({0,0,0,0}), tint(WHITE) {}
+    SpriteRect(Rectangle src, Vector2 pos, Vector2 prevPos, Boundaries boundaries, Color tint) : source(src), position(pos), previousPosition(prevPos), boundaries(boundaries), tint(tint) {}
+};
+
+// Visible chunk of cached static terrain. The sprites of a chunk are only sent (as a range of frame sprites) when its
+// version changes or it becomes visible, until the render thread takes a frame holding them, which it then uses to
+// redraw its cached copy of the chunk.
+struct TerrainChunkRef {
+  uint32_t chunk;
+  uint32_t version;
+  uint32_t firstSprite;
+  uint32_t spriteCount;
+  bool hasSprites; // False when the render thread already has this version
+};
+
+// Everything the render thread needs to draw one game logic tick.
+struct SpriteRectFrame {
+  SpriteRect* sprites = nullptr;
+  uint32_t length = 0;
+  uint32_t firstDynamicSprite = 0; // Sprites before this index are cached terrain referenced by terrainChunks
+  TerrainChunkRef terrainChunks[MAX_VISIBLE_TERRAIN_CHUNKS];
+  uint32_t terrainChunkCount = 0;
+  uint64_t tick = 0;
+  float inputLatency = 0.0f; // Milliseconds, see EntityManager::drainInputQueue
+  float cameraPosition = INITIAL_CAMERA_POSITION;
+  float previousCameraPosition = INITIAL_CAMERA_POSITION;
+  std::chrono::steady_clock::time_point timestamp; // When the frame was published
+};
+
+// Wait-free single producer / single consumer triple buffer. The producer (game logic thread) owns one frame, the
+// consumer (render thread) owns another one and the third is exchanged atomically between them, so none of the
+// threads ever waits for the other and the consumer always gets the latest published frame.
+class SpriteRectTripleBuffer {
+  static constexpr uint8_t INDEX_MASK = 0x3;
+  static constexpr uint8_t FRESH_FRAME_FLAG = 0x4; // The exchanged frame was published after the consumer last took it
+
+  SpriteRectFrame frames[3];
+  uint8_t producer_index = 0;
+  uint8_t consumer_index = 2;
+  std::atomic<uint8_t> middle_index{1};
+  std::atomic<uint64_t> consumed_tick{0}; // Tick of the last frame taken by the consumer
+
+public:
+  uint32_t max_length;
+
+  SpriteRectTripleBuffer(uint32_t);
+  uint32_t buffer_size();
+  SpriteRectFrame& producerFrame();
+  void publish();
+  const SpriteRectFrame& consumerFrame();
+  uint64_t consumedTick();
+  ~SpriteRectTripleBuffer();
+};
+
+#endif
@@ -43,13 +43,11 @@ void StateMachine::ExternalEvent(unsigned char newState,
 }
 
 // generates an internal event. called from within a state
-// function to transition to a new state
+// function to transition to a new state. event data is optional:
+// events without data are dispatched without allocating anything
 void StateMachine::InternalEvent(unsigned char newState,
                                  EventData* pData)
 {
-	if (pData == NULL)
-		pData = new EventData();
-
     _pEventData = pData;
     _eventGenerated = true;
     currentState = newState;
@@ -18,6 +18,7 @@ class StateMachine
     StateMachine();
     StateMachine(unsigned char _maxStates);
     virtual ~StateMachine() {}
+    unsigned char GetCurrentState() const { return currentState; }
 protected:
     enum { EVENT_IGNORED = 0xFE, CANNOT_HAPPEN };
     unsigned char currentState;
@@ -0,0 +1,75 @@
+#include <terrain_cache.h>
+
+TerrainCache::TerrainCache(Texture2D _texture) {
+  texture = _texture;
+}
+
+// Redraws the visible chunks whose sprites are sent with a new version and frees the chunks that are no longer
+// visible. Must be called outside of BeginMode2D/EndMode2D.
+void TerrainCache::Update(const SpriteRectFrame& frame) {
+  uint32_t firstChunk = frame.terrainChunkCount > 0 ? frame.terrainChunks[0].chunk : 0;
+  uint32_t lastChunk = frame.terrainChunkCount > 0 ? frame.terrainChunks[frame.terrainChunkCount - 1].chunk : 0;
+  for (uint32_t c = 0; c < chunks.size(); c++) {
+    if (chunks[c].target.id != 0 && (frame.terrainChunkCount == 0 || c < firstChunk || c > lastChunk)) {
+      UnloadRenderTexture(chunks[c].target);
+      chunks[c] = CachedChunk();
+    }
+  }
+
+  for (uint32_t c = 0; c < frame.terrainChunkCount; c++) {
+    const TerrainChunkRef& chunkRef = frame.terrainChunks[c];
+    if (!chunkRef.hasSprites) {
+      continue;
+    }
+    if (chunkRef.chunk >= chunks.size()) {
+      chunks.resize(chunkRef.chunk + 1);
+    }
+
+    CachedChunk& chunk = chunks[chunkRef.chunk];
+    if (chunk.target.id == 0) {
+      chunk.target = LoadRenderTexture(LEVEL_WIDTH + 2 * PADDING, TERRAIN_CHUNK_ROWS * CELL_HEIGHT + 2 * PADDING);
+      Render(frame, chunkRef);
+    } else if (chunk.version != chunkRef.version) {
+      Render(frame, chunkRef);
+    }
+  }
+}
+
+void TerrainCache::Render(const SpriteRectFrame& frame, const TerrainChunkRef& chunkRef) {
+  CachedChunk& chunk = chunks[chunkRef.chunk];
+  float originX = -PADDING;
+  float originY = chunkRef.chunk * TERRAIN_CHUNK_ROWS * CELL_HEIGHT_FLOAT - PADDING;
+
+  BeginTextureMode(chunk.target);
+    ClearBackground(BLANK);
+    for (uint32_t i = chunkRef.firstSprite; i < chunkRef.firstSprite + chunkRef.spriteCount; i++) {
+      const SpriteRect& sprite = frame.sprites[i];
+      DrawTextureRec(texture, sprite.source, { sprite.position.x - originX, sprite.position.y - originY }, WHITE);
+    }
+  EndTextureMode();
+
+  chunk.version = chunkRef.version;
+}
+
+// Blits the visible chunks. Render textures are stored upside down, hence the negative source height.
+void TerrainCache::Draw(const SpriteRectFrame& frame) {
+  for (uint32_t c = 0; c < frame.terrainChunkCount; c++) {
+    const TerrainChunkRef& chunkRef = frame.terrainChunks[c];
+    if (chunkRef.chunk >= chunks.size() || chunks[chunkRef.chunk].target.id == 0) {
+      continue;
+    }
+
+    const RenderTexture2D& target = chunks[chunkRef.chunk].target;
+    Rectangle source = { 0, 0, static_cast<float>(target.texture.width), -static_cast<float>(target.texture.height) };
+    Vector2 position = { -PADDING, chunkRef.chunk * TERRAIN_CHUNK_ROWS * CELL_HEIGHT_FLOAT - PADDING };
+    DrawTextureRec(target.texture, source, position, WHITE);
+  }
+}
+
+TerrainCache::~TerrainCache() {
+  for (auto& chunk : chunks) {
+    if (chunk.target.id != 0) {
+      UnloadRenderTexture(chunk.target);
+    }
+  }
+}
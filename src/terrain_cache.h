@@ -0,0 +1,31 @@
+#ifndef TERRAIN_CACHE_H
+#define TERRAIN_CACHE_H
+
+#include <vector>
+#include <raylib/raylib.h>
+#include <sprite_rect_triple_buffer.h>
+
+// Render thread copy of the static terrain. Every chunk of TERRAIN_CHUNK_ROWS rows is drawn once into its own render
+// texture and blitted afterwards, so motionless bricks and walls are not drawn one by one every frame. A chunk is
+// redrawn only when the game logic publishes a new version of it, and freed once it leaves the visible chunks.
+class TerrainCache {
+  static constexpr int PADDING = CELL_HEIGHT; // Room for sprites overhanging the chunk cells
+
+  struct CachedChunk {
+    RenderTexture2D target = {};
+    uint32_t version = 0;
+  };
+
+  Texture2D texture;
+  std::vector<CachedChunk> chunks;
+
+  void Render(const SpriteRectFrame&, const TerrainChunkRef&);
+
+public:
+  TerrainCache(Texture2D);
+  void Update(const SpriteRectFrame&);
+  void Draw(const SpriteRectFrame&);
+  ~TerrainCache();
+};
+
+#endif
@@ -0,0 +1,65 @@
+#include <algorithm>
+#include <terrain_grid.h>
+
+void TerrainGrid::Resize(int _columns, int _rows) {
+  columns = _columns;
+  rows = _rows;
+  occupancy.assign(rows, 0);
+  cells.assign(static_cast<size_t>(columns) * rows, EntityHandle());
+}
+
+void TerrainGrid::Set(int cellX, int cellY, EntityHandle handle) {
+  if (!IsInside(cellX, cellY)) {
+    return;
+  }
+
+  occupancy[cellY] |= (1u << cellX);
+  cells[cellY * columns + cellX] = handle;
+}
+
+// Empties the cell only if it is still held by the given object (the cell may have been filled again meanwhile).
+void TerrainGrid::Clear(int cellX, int cellY, EntityHandle handle) {
+  if (!IsInside(cellX, cellY) || cells[cellY * columns + cellX] != handle) {
+    return;
+  }
+
+  occupancy[cellY] &= ~(1u << cellX);
+  cells[cellY * columns + cellX] = EntityHandle();
+}
+
+std::optional<EntityHandle> TerrainGrid::GetHandle(int cellX, int cellY) const {
+  if (!IsSolid(cellX, cellY)) {
+    return std::nullopt;
+  }
+  return cells[cellY * columns + cellX];
+}
+
+// Bits of the columns firstCellX..lastCellX (both included) clipped to the grid width.
+uint32_t TerrainGrid::SpanMask(int firstCellX, int lastCellX) const {
+  firstCellX = std::max(firstCellX, 0);
+  lastCellX = std::min(lastCellX, columns - 1);
+  if (firstCellX > lastCellX) {
+    return 0;
+  }
+
+  uint32_t upToLast = (lastCellX >= 31) ? 0xFFFFFFFFu : ((1u << (lastCellX + 1)) - 1);
+  return upToLast & ~((1u << firstCellX) - 1);
+}
+
+// Returns the leftmost empty column of the row span firstCellX..lastCellX, if any.
+std::optional<int> TerrainGrid::FindHole(int cellY, int firstCellX, int lastCellX) const {
+  uint32_t row = (cellY >= 0 && cellY < rows) ? occupancy[cellY] : 0;
+  uint32_t holes = ~row & SpanMask(firstCellX, lastCellX);
+  if (holes == 0) {
+    return std::nullopt;
+  }
+  return __builtin_ctz(holes);
+}
+
+// Number of solid cells of the row span firstCellX..lastCellX.
+int TerrainGrid::CountSolid(int cellY, int firstCellX, int lastCellX) const {
+  if (cellY < 0 || cellY >= rows) {
+    return 0;
+  }
+  return __builtin_popcount(occupancy[cellY] & SpanMask(firstCellX, lastCellX));
+}
@@ -0,0 +1,34 @@
+#ifndef TERRAIN_GRID_H
+#define TERRAIN_GRID_H
+
+#include <vector>
+#include <optional>
+#include <cstdint>
+#include <defines.h>
+#include <slot_map.h>
+
+static_assert(LEVEL_WIDTH_CELLS <= 32, "A terrain grid row must fit in a 32 bits word");
+
+// Solid terrain of the mountain indexed by map cell. Every row is an occupancy bitset (bit N set when column N holds a
+// solid brick) plus the handle of the object in each cell, so ground and hole checks do not need to query the space
+// partition tree. Out of range cells are reported as empty.
+class TerrainGrid {
+  int columns = 0;
+  int rows = 0;
+  std::vector<uint32_t> occupancy; // One bitset per row
+  std::vector<EntityHandle> cells; // Object of every cell, row major
+
+  bool IsInside(int cellX, int cellY) const { return cellX >= 0 && cellX < columns && cellY >= 0 && cellY < rows; }
+  uint32_t SpanMask(int, int) const;
+
+public:
+  void Resize(int, int);
+  void Set(int, int, EntityHandle);
+  void Clear(int, int, EntityHandle);
+  bool IsSolid(int cellX, int cellY) const { return IsInside(cellX, cellY) && (occupancy[cellY] & (1u << cellX)); }
+  std::optional<EntityHandle> GetHandle(int, int) const;
+  std::optional<int> FindHole(int, int, int) const;
+  int CountSolid(int, int, int) const;
+};
+
+#endif
@@ -28,6 +28,7 @@
 #define _AABB_H
 
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <cstdlib>
 #include <iostream>
@@ -40,6 +41,9 @@
 /// Null node flag.
 const unsigned int NULL_NODE = 0xffffffff;
 
+/// Category bits of a particle matching every query mask.
+const unsigned int ALL_CATEGORIES = 0xffffffff;
+
 namespace aabb
 {
     template <class T>
@@ -48,12 +52,23 @@ namespace aabb
         int leftIntersectionX, rightIntersectionX, topIntersectionY, bottomIntersectionY;
     };
 
+    /// Fixed size 2D integer box used by the allocation-free queries.
+    struct Bounds2i {
+        int lowerX, lowerY, upperX, upperY;
+    };
+
+    /// Dimensionality of the tree. Bounds are stored inline, so it is fixed at compile time.
+    constexpr unsigned int DIMENSION = 2;
+
+    /// Coordinates of a bound, one per dimension.
+    typedef std::array<float, DIMENSION> Bound;
+
     /*! \brief The axis-aligned bounding box object.
 
         Axis-aligned bounding boxes (AABBs) store information for the minimum
-        orthorhombic bounding-box for an object. Support is provided for
-        dimensions >= 2. (In 2D the bounding box is either a rectangle,
-        in 3D it is a rectangular prism.)
+        orthorhombic bounding-box for an object. The bounds are stored inline
+        (no heap allocation) for the fixed 2D dimensionality of the tree, so
+        a box is a rectangle.
 
         Class member functions provide functionality for merging AABB objects
         and testing overlap with other AABBs.
@@ -62,16 +77,16 @@ namespace aabb
     {
     public:
         /// Lower bound of AABB in each dimension.
-        std::vector<double> lowerBound;
+        Bound lowerBound{};
 
         /// Upper bound of AABB in each dimension.
-        std::vector<double> upperBound;
+        Bound upperBound{};
 
         /// The position of the AABB centre.
-        std::vector<double> centre;
+        Bound centre{};
 
         /// The AABB's surface area.
-        double surfaceArea;
+        float surfaceArea = 0;
 
         AABB()
         {
@@ -79,23 +94,14 @@ namespace aabb
 
         AABB(unsigned int dimension)
         {
-            assert(dimension >= 2);
-
-            lowerBound.resize(dimension);
-            upperBound.resize(dimension);
+            assert(dimension == DIMENSION);
         }
 
-        AABB(const std::vector<double>& lowerBound_, const std::vector<double>& upperBound_) :
+        AABB(const Bound& lowerBound_, const Bound& upperBound_) :
             lowerBound(lowerBound_), upperBound(upperBound_)
         {
-            // Validate the dimensionality of the bounds vectors.
-            if (lowerBound.size() != upperBound.size())
-            {
-                throw std::invalid_argument("[ERROR]: Dimensionality mismatch!");
-            }
-
             // Validate that the upper bounds exceed the lower bounds.
-            for (unsigned int i=0;i<lowerBound.size();i++)
+            for (unsigned int i=0;i<DIMENSION;i++)
             {
                 // Validate the bound.
                 if (lowerBound[i] > upperBound[i])
@@ -108,24 +114,30 @@ namespace aabb
             centre = computeCentre();
         }
 
-        double computeSurfaceArea() const
+        AABB(const Bounds2i& bounds) :
+            AABB({static_cast<float>(bounds.lowerX), static_cast<float>(bounds.lowerY)},
+                 {static_cast<float>(bounds.upperX), static_cast<float>(bounds.upperY)})
+        {
+        }
+
+        float computeSurfaceArea() const
         {
             // Sum of "area" of all the sides.
-            double sum = 0;
+            float sum = 0;
 
             // General formula for one side: hold one dimension constant
             // and multiply by all the other ones.
-            for (unsigned int d1 = 0; d1 < lowerBound.size(); d1++)
+            for (unsigned int d1 = 0; d1 < DIMENSION; d1++)
             {
                 // "Area" of current side.
-                double product = 1;
+                float product = 1;
 
-                for (unsigned int d2 = 0; d2 < lowerBound.size(); d2++)
+                for (unsigned int d2 = 0; d2 < DIMENSION; d2++)
                 {
                     if (d1 == d2)
                         continue;
 
-                    double dx = upperBound[d2] - lowerBound[d2];
+                    float dx = upperBound[d2] - lowerBound[d2];
                     product *= dx;
                 }
 
@@ -133,23 +145,17 @@ namespace aabb
                 sum += product;
             }
 
-            return 2.0 * sum;
+            return 2.0f * sum;
         }
 
-        double getSurfaceArea() const
+        float getSurfaceArea() const
         {
             return surfaceArea;
         }
 
         void merge(const AABB& aabb1, const AABB& aabb2)
         {
-            assert(aabb1.lowerBound.size() == aabb2.lowerBound.size());
-            assert(aabb1.upperBound.size() == aabb2.upperBound.size());
-
-            lowerBound.resize(aabb1.lowerBound.size());
-            upperBound.resize(aabb1.lowerBound.size());
-
-            for (unsigned int i=0;i<lowerBound.size();i++)
+            for (unsigned int i=0;i<DIMENSION;i++)
             {
                 lowerBound[i] = std::min(aabb1.lowerBound[i], aabb2.lowerBound[i]);
                 upperBound[i] = std::max(aabb1.upperBound[i], aabb2.upperBound[i]);
@@ -161,9 +167,7 @@ namespace aabb
 
         bool contains(const AABB& aabb) const
         {
-            assert(aabb.lowerBound.size() == lowerBound.size());
-
-            for (unsigned int i=0;i<lowerBound.size();i++)
+            for (unsigned int i=0;i<DIMENSION;i++)
             {
                 if (aabb.lowerBound[i] < lowerBound[i]) return false;
                 if (aabb.upperBound[i] > upperBound[i]) return false;
@@ -174,14 +178,11 @@ namespace aabb
 
         bool overlaps(const AABB& aabb, bool touchIsOverlap) const
         {
-            assert(aabb.lowerBound.size() == 2); // Only 2 dimensional boundaries allowed
-            assert(aabb.lowerBound.size() == lowerBound.size());
-
             bool rv = true;
 
             if (touchIsOverlap)
             {
-                for (unsigned int i = 0; i < lowerBound.size(); ++i)
+                for (unsigned int i = 0; i < DIMENSION; ++i)
                 {
                     if (aabb.upperBound[i] < lowerBound[i] || aabb.lowerBound[i] > upperBound[i])
                     {
@@ -192,7 +193,7 @@ namespace aabb
             }
             else
             {
-                for (unsigned int i = 0; i < lowerBound.size(); ++i)
+                for (unsigned int i = 0; i < DIMENSION; ++i)
                 {
                     if (aabb.upperBound[i] <= lowerBound[i] || aabb.lowerBound[i] >= upperBound[i])
                     {
@@ -205,22 +206,19 @@ namespace aabb
             return rv;
         }
 
-        std::vector<double> computeCentre()
+        Bound computeCentre() const
         {
-            std::vector<double> position(lowerBound.size());
+            Bound position;
 
-            for (unsigned int i=0;i<position.size();i++)
-                position[i] = 0.5 * (lowerBound[i] + upperBound[i]);
+            for (unsigned int i=0;i<DIMENSION;i++)
+                position[i] = 0.5f * (lowerBound[i] + upperBound[i]);
 
             return position;
         }
 
         void setDimension(unsigned int dimension)
         {
-            assert(dimension >= 2);
-
-            lowerBound.resize(dimension);
-            upperBound.resize(dimension);
+            assert(dimension == DIMENSION);
         }
 
     };
@@ -269,6 +267,9 @@ namespace aabb
         /// Height of the node. This is 0 for a leaf and -1 for a free node.
         int height;
 
+        /// Category bits of the particle (leaf nodes) or union of the categories of the subtree.
+        unsigned int categories;
+
         /// The index of the particle that the node contains (leaf nodes only).
         T particle;
 
@@ -305,7 +306,7 @@ namespace aabb
             \param touchIsOverlap
                 Does touching count as overlapping in query operations?
          */
-        Tree(unsigned int dimension_= 3, double skinThickness_ = 0.05,
+        Tree(unsigned int dimension_= DIMENSION, double skinThickness_ = 0.05,
             unsigned int nParticles = 16, bool touchIsOverlap=true);
 
         //! Constructor (custom periodicity).
@@ -361,13 +362,13 @@ namespace aabb
         /*! \param index
                 The index of the particle.
 
-            \param lowerBound
-                The lower bound in each dimension.
+            \param bounds
+                The 2D integer bounding box.
 
-            \param upperBound
-                The upper bound in each dimension.
+            \param categories
+                Category bits of the particle, matched against the query masks.
          */
-        void insertParticle(T, std::vector<int>&, std::vector<int>&);
+        void insertParticle(T, const Bounds2i&, unsigned int categories=ALL_CATEGORIES);
         //! Insert a particle into the tree (arbitrary shape with bounding box).
         /*! \param index
                 The index of the particle.
@@ -414,16 +415,13 @@ namespace aabb
         /*! \param particle
                 The particle index (particleMap will be used to map the node).
 
-            \param lowerBound
-                The lower bound in each dimension.
-
-            \param upperBound
-                The upper bound in each dimension.
+            \param bounds
+                The 2D integer bounding box.
 
             \param alwaysReinsert
                 Always reinsert the particle, even if it's within its old AABB (default: false)
          */
-        bool updateParticle(T, std::vector<int>&, std::vector<int>&, bool alwaysReinsert=false);
+        bool updateParticle(T, const Bounds2i&, bool alwaysReinsert=false);
 
         //! Update the tree if a particle moves outside its fattened AABB.
         /*! \param particle
@@ -482,12 +480,71 @@ namespace aabb
          */
         std::vector<AABBIntersection<T>> query(const AABB&);
 
+        //! Query the tree for a 2D integer box without allocating.
+        /*! Only for non periodic trees. The traversal stack is reused between
+            queries, so the visitor must not query the tree again.
+
+            \param bounds
+                The box.
+
+            \param visitor
+                Callable invoked with every AABBIntersection<T> found.
+         */
+        template <class Visitor>
+        void query(const Bounds2i&, Visitor&&);
+
+        //! Query the tree for a 2D integer box without allocating.
+        /*! Same as query, but the visitor is invoked with the particle and
+            its fattened AABB instead of the intersection values.
+
+            \param bounds
+                The box.
+
+            \param visitor
+                Callable invoked with (T, const AABB&) for every overlapping leaf.
+         */
+        template <class Visitor>
+        void queryLeaves(const Bounds2i&, Visitor&&);
+
+        //! Query the tree for a 2D integer box without allocating.
+        /*! Same as queryLeaves, but only the particles whose categories match
+            the mask are visited. Subtrees with no matching category are
+            pruned during the traversal.
+
+            \param bounds
+                The box.
+
+            \param mask
+                Category bits of the particles to visit.
+
+            \param visitor
+                Callable invoked with (T, const AABB&) for every overlapping leaf.
+         */
+        template <class Visitor>
+        void queryLeaves(const Bounds2i&, unsigned int mask, Visitor&&);
+
+        //! Query the tree for a 2D integer box without allocating.
+        /*! \param bounds
+                The box.
+
+            \param intersections
+                Caller-owned buffer. The intersections are appended to it, so
+                once it has grown the query does not allocate.
+         */
+        void query(const Bounds2i&, std::vector<AABBIntersection<T>>&);
+
         //! Get a particle AABB.
         /*! \param particle
                 The particle index.
          */
         const AABB& getAABB(T);
 
+        //! Get a particle AABB, if the particle is in the tree.
+        /*! \param particle
+                The particle index.
+         */
+        std::optional<AABB> findAABB(T);
+
         //! Get the height of the tree.
         /*! \return
                 The height of the binary tree.
@@ -563,12 +620,21 @@ namespace aabb
         /// Does touching count as overlapping in tree queries?
         bool touchIsOverlap;
 
+        /// Traversal stack reused by the allocation-free queries.
+        std::vector<unsigned int> queryStack;
+
         //! Allocate a new node.
         /*! \return
                 The index of the allocated node.
          */
         unsigned int allocateNode();
 
+        //! Insert a particle with the given (not yet fattened) bounds.
+        void insertParticle(T, const Bound&, const Bound&, unsigned int categories=ALL_CATEGORIES);
+
+        //! Update a particle with the given (not yet fattened) bounds.
+        bool updateParticle(T, const Bound&, const Bound&, bool);
+
         //! Free an existing node.
         /*! \param node
                 The index of the node to be freed.
@@ -624,7 +690,7 @@ namespace aabb
         /* \param position
                 The position vector.
          */
-        void periodicBoundaries(std::vector<double>&);
+        void periodicBoundaries(Bound&);
 
         //! Compute minimum image separation.
         /*! \param separation
@@ -636,7 +702,7 @@ namespace aabb
             \return
                 Whether a periodic shift has been applied.
          */
-        bool minimumImage(std::vector<double>&, std::vector<double>&);
+        bool minimumImage(Bound&, Bound&);
     };
 
     template <class T>
@@ -663,7 +729,7 @@ namespace aabb
         touchIsOverlap(touchIsOverlap_)
     {
         // Validate the dimensionality.
-        if ((dimension < 2))
+        if (dimension != DIMENSION)
         {
             throw std::invalid_argument("[ERROR]: Invalid dimensionality!");
         }
@@ -705,7 +771,7 @@ namespace aabb
         touchIsOverlap(touchIsOverlap_)
     {
         // Validate the dimensionality.
-        if (dimension < 2)
+        if (dimension != DIMENSION)
         {
             throw std::invalid_argument("[ERROR]: Invalid dimensionality!");
         }
@@ -739,7 +805,7 @@ namespace aabb
         isPeriodic = false;
         posMinImage.resize(dimension);
         negMinImage.resize(dimension);
-        for (unsigned int i=0;i<dimension;i++)
+        for (unsigned int i=0;i<DIMENSION;i++)
         {
             posMinImage[i] =  0.5*boxSize[i];
             negMinImage[i] = -0.5*boxSize[i];
@@ -754,7 +820,10 @@ namespace aabb
     template <class T>
     void Tree<T>::setDimension(const int dimension_)
     {
-        dimension = dimension_;
+        if (dimension_ != static_cast<int>(DIMENSION))
+        {
+            throw std::invalid_argument("[ERROR]: Invalid dimensionality!");
+        }
     }
 
     template <class T>
@@ -801,7 +870,6 @@ namespace aabb
         nodes[node].left = NULL_NODE;
         nodes[node].right = NULL_NODE;
         nodes[node].height = 0;
-        nodes[node].aabb.setDimension(dimension);
         nodeCount++;
 
         return node;
@@ -826,73 +894,52 @@ namespace aabb
     template <class T>
     void Tree<T>::insertParticle(T particle, std::vector<double>& position, double radius)
     {
-        // Make sure the particle doesn't already exist.
-        if (particleMap.count(particle) != 0)
-        {
-            throw std::invalid_argument("[ERROR]: Particle already exists in tree!");
-        }
-
         // Validate the dimensionality of the position vector.
         if (position.size() != dimension)
         {
             throw std::invalid_argument("[ERROR]: Dimensionality mismatch!");
         }
 
-        // Allocate a new node for the particle.
-        unsigned int node = allocateNode();
-
-        // AABB size in each dimension.
-        std::vector<double> size(dimension);
-
         // Compute the AABB limits.
-        for (unsigned int i=0;i<dimension;i++)
+        Bound lowerBound, upperBound;
+        for (unsigned int i=0;i<DIMENSION;i++)
         {
-            nodes[node].aabb.lowerBound[i] = position[i] - radius;
-            nodes[node].aabb.upperBound[i] = position[i] + radius;
-            size[i] = nodes[node].aabb.upperBound[i] - nodes[node].aabb.lowerBound[i];
+            lowerBound[i] = static_cast<float>(position[i] - radius);
+            upperBound[i] = static_cast<float>(position[i] + radius);
         }
 
-        // Fatten the AABB.
-        for (unsigned int i=0;i<dimension;i++)
-        {
-            nodes[node].aabb.lowerBound[i] -= skinThickness * size[i];
-            nodes[node].aabb.upperBound[i] += skinThickness * size[i];
-        }
-        nodes[node].aabb.surfaceArea = nodes[node].aabb.computeSurfaceArea();
-        nodes[node].aabb.centre = nodes[node].aabb.computeCentre();
-
-        // Zero the height.
-        nodes[node].height = 0;
-
-        // Insert a new leaf into the tree.
-        insertLeaf(node);
-
-        // Add the new particle to the map.
-        particleMap.insert(std::pair<T,int>(particle,node));
-
-        // Store the particle index.
-        nodes[node].particle = particle;
+        insertParticle(particle, lowerBound, upperBound);
     }
 
     template <class T>
-    void Tree<T>::insertParticle(T particle, std::vector<int>& lowerBound_, std::vector<int>& upperBound_)
+    void Tree<T>::insertParticle(T particle, const Bounds2i& bounds, unsigned int categories)
     {
-        std::vector<double> lowerBound;
-        std::vector<double> upperBound;
+        Bound lowerBound = {static_cast<float>(bounds.lowerX), static_cast<float>(bounds.lowerY)};
+        Bound upperBound = {static_cast<float>(bounds.upperX), static_cast<float>(bounds.upperY)};
+        insertParticle(particle, lowerBound, upperBound, categories);
+    }
 
-        for(int i=0; i<lowerBound_.size(); i++) {
-          lowerBound.push_back((double)lowerBound_.at(i));
+    template <class T>
+    void Tree<T>::insertParticle(T particle, std::vector<double>& lowerBound_, std::vector<double>& upperBound_)
+    {
+        // Validate the dimensionality of the bounds vectors.
+        if ((lowerBound_.size() != dimension) || (upperBound_.size() != dimension))
+        {
+            throw std::invalid_argument("[ERROR]: Dimensionality mismatch!");
         }
 
-        for(int i=0; i<upperBound_.size(); i++) {
-          upperBound.push_back((double)upperBound_.at(i));
+        Bound lowerBound, upperBound;
+        for (unsigned int i=0;i<DIMENSION;i++)
+        {
+            lowerBound[i] = static_cast<float>(lowerBound_[i]);
+            upperBound[i] = static_cast<float>(upperBound_[i]);
         }
 
         insertParticle(particle, lowerBound, upperBound);
     }
 
     template <class T>
-    void Tree<T>::insertParticle(T particle, std::vector<double>& lowerBound, std::vector<double>& upperBound)
+    void Tree<T>::insertParticle(T particle, const Bound& lowerBound, const Bound& upperBound, unsigned int categories)
     {
         // Make sure the particle doesn't already exist.
         if (particleMap.count(particle) != 0)
@@ -900,20 +947,14 @@ namespace aabb
             throw std::invalid_argument("[ERROR]: Particle already exists in tree!");
         }
 
-        // Validate the dimensionality of the bounds vectors.
-        if ((lowerBound.size() != dimension) || (upperBound.size() != dimension))
-        {
-            throw std::invalid_argument("[ERROR]: Dimensionality mismatch!");
-        }
-
         // Allocate a new node for the particle.
         unsigned int node = allocateNode();
 
         // AABB size in each dimension.
-        std::vector<double> size(dimension);
+        Bound size;
 
         // Compute the AABB limits.
-        for (unsigned int i=0;i<dimension;i++)
+        for (unsigned int i=0;i<DIMENSION;i++)
         {
             // Validate the bound.
             if (lowerBound[i] > upperBound[i])
@@ -927,7 +968,7 @@ namespace aabb
         }
 
         // Fatten the AABB.
-        for (unsigned int i=0;i<dimension;i++)
+        for (unsigned int i=0;i<DIMENSION;i++)
         {
             nodes[node].aabb.lowerBound[i] -= skinThickness * size[i];
             nodes[node].aabb.upperBound[i] += skinThickness * size[i];
@@ -937,6 +978,7 @@ namespace aabb
 
         // Zero the height.
         nodes[node].height = 0;
+        nodes[node].categories = categories;
 
         // Insert a new leaf into the tree.
         insertLeaf(node);
@@ -1017,15 +1059,12 @@ namespace aabb
             throw std::invalid_argument("[ERROR]: Dimensionality mismatch!");
         }
 
-        // AABB bounds vectors.
-        std::vector<double> lowerBound(dimension);
-        std::vector<double> upperBound(dimension);
-
         // Compute the AABB limits.
-        for (unsigned int i=0;i<dimension;i++)
+        Bound lowerBound, upperBound;
+        for (unsigned int i=0;i<DIMENSION;i++)
         {
-            lowerBound[i] = position[i] - radius;
-            upperBound[i] = position[i] + radius;
+            lowerBound[i] = static_cast<float>(position[i] - radius);
+            upperBound[i] = static_cast<float>(position[i] + radius);
         }
 
         // Update the particle.
@@ -1033,32 +1072,37 @@ namespace aabb
     }
 
     template <class T>
-    bool Tree<T>::updateParticle(T particle, std::vector<int>& lowerBound_, std::vector<int>& upperBound_, bool alwaysReinsert)
+    bool Tree<T>::updateParticle(T particle, const Bounds2i& bounds, bool alwaysReinsert)
     {
-        std::vector<double> lowerBound;
-        std::vector<double> upperBound;
-
-        for(int i=0; i<lowerBound_.size(); i++) {
-          lowerBound.push_back((double)lowerBound_.at(i));
-        }
-
-        for(int i=0; i<upperBound_.size(); i++) {
-          upperBound.push_back((double)upperBound_.at(i));
-        }
-
+        Bound lowerBound = {static_cast<float>(bounds.lowerX), static_cast<float>(bounds.lowerY)};
+        Bound upperBound = {static_cast<float>(bounds.upperX), static_cast<float>(bounds.upperY)};
         return updateParticle(particle, lowerBound, upperBound, alwaysReinsert);
     }
 
     template <class T>
-    bool Tree<T>::updateParticle(T particle, std::vector<double>& lowerBound,
-                              std::vector<double>& upperBound, bool alwaysReinsert)
+    bool Tree<T>::updateParticle(T particle, std::vector<double>& lowerBound_,
+                              std::vector<double>& upperBound_, bool alwaysReinsert)
     {
         // Validate the dimensionality of the bounds vectors.
-        if ((lowerBound.size() != dimension) && (upperBound.size() != dimension))
+        if ((lowerBound_.size() != dimension) || (upperBound_.size() != dimension))
         {
             throw std::invalid_argument("[ERROR]: Dimensionality mismatch!");
         }
 
+        Bound lowerBound, upperBound;
+        for (unsigned int i=0;i<DIMENSION;i++)
+        {
+            lowerBound[i] = static_cast<float>(lowerBound_[i]);
+            upperBound[i] = static_cast<float>(upperBound_[i]);
+        }
+
+        return updateParticle(particle, lowerBound, upperBound, alwaysReinsert);
+    }
+
+    template <class T>
+    bool Tree<T>::updateParticle(T particle, const Bound& lowerBound,
+                              const Bound& upperBound, bool alwaysReinsert)
+    {
         // Map iterator.
         typename std::map<T, unsigned int>::iterator it;
 
@@ -1078,10 +1122,10 @@ namespace aabb
         assert(nodes[node].isLeaf());
 
         // AABB size in each dimension.
-        std::vector<double> size(dimension);
+        Bound size;
 
         // Compute the AABB limits.
-        for (unsigned int i=0;i<dimension;i++)
+        for (unsigned int i=0;i<DIMENSION;i++)
         {
             // Validate the bound.
             if (lowerBound[i] > upperBound[i])
@@ -1102,7 +1146,7 @@ namespace aabb
         removeLeaf(node);
 
         // Fatten the new AABB.
-        for (unsigned int i=0;i<dimension;i++)
+        for (unsigned int i=0;i<DIMENSION;i++)
         {
             aabb.lowerBound[i] -= skinThickness * size[i];
             aabb.upperBound[i] += skinThickness * size[i];
@@ -1155,9 +1199,9 @@ namespace aabb
 
             if (isPeriodic)
             {
-                std::vector<double> separation(dimension);
-                std::vector<double> shift(dimension);
-                for (unsigned int i=0;i<dimension;i++)
+                Bound separation;
+                Bound shift{};
+                for (unsigned int i=0;i<DIMENSION;i++)
                     separation[i] = nodeAABB.centre[i] - aabb.centre[i];
 
                 bool isShifted = minimumImage(separation, shift);
@@ -1165,7 +1209,7 @@ namespace aabb
                 // Shift the AABB.
                 if (isShifted)
                 {
-                    for (unsigned int i=0;i<dimension;i++)
+                    for (unsigned int i=0;i<DIMENSION;i++)
                     {
                         nodeAABB.lowerBound[i] += shift[i];
                         nodeAABB.upperBound[i] += shift[i];
@@ -1204,18 +1248,14 @@ namespace aabb
     template <class T>
     std::vector<AABBIntersection<T>> Tree<T>::query(const std::vector<int> lowerBound_, const std::vector<int> upperBound_)
     {
-        std::vector<double> lowerBound;
-        std::vector<double> upperBound;
-
-        for(int i=0; i<lowerBound_.size(); i++) {
-          lowerBound.push_back((double)lowerBound_.at(i));
-        }
-
-        for(int i=0; i<upperBound_.size(); i++) {
-          upperBound.push_back((double)upperBound_.at(i));
+        // Validate the dimensionality of the bounds vectors.
+        if ((lowerBound_.size() != dimension) || (upperBound_.size() != dimension))
+        {
+            throw std::invalid_argument("[ERROR]: Dimensionality mismatch!");
         }
 
-        AABB aabb(lowerBound, upperBound);
+        Bounds2i bounds = {lowerBound_[0], lowerBound_[1], upperBound_[0], upperBound_[1]};
+        AABB aabb(bounds);
         return query(aabb);
     }
 
@@ -1232,12 +1272,93 @@ namespace aabb
         return query(std::numeric_limits<T>::max(), aabb);
     }
 
+    template <class T>
+    template <class Visitor>
+    void Tree<T>::queryLeaves(const Bounds2i& bounds, Visitor&& visitor)
+    {
+        queryLeaves(bounds, ALL_CATEGORIES, std::forward<Visitor>(visitor));
+    }
+
+    template <class T>
+    template <class Visitor>
+    void Tree<T>::queryLeaves(const Bounds2i& bounds, unsigned int mask, Visitor&& visitor)
+    {
+        assert(!isPeriodic);
+
+        if (root == NULL_NODE) return;
+
+        queryStack.clear();
+        queryStack.push_back(root);
+
+        while (!queryStack.empty())
+        {
+            unsigned int node = queryStack.back();
+            queryStack.pop_back();
+
+            // No particle of the subtree matches the mask.
+            if ((nodes[node].categories & mask) == 0) continue;
+
+            // Test for overlap between the box and the node AABB (without copying it).
+            const AABB& nodeAABB = nodes[node].aabb;
+            if (touchIsOverlap)
+            {
+                if (bounds.upperX < nodeAABB.lowerBound[0] || bounds.lowerX > nodeAABB.upperBound[0] ||
+                    bounds.upperY < nodeAABB.lowerBound[1] || bounds.lowerY > nodeAABB.upperBound[1]) continue;
+            }
+            else
+            {
+                if (bounds.upperX <= nodeAABB.lowerBound[0] || bounds.lowerX >= nodeAABB.upperBound[0] ||
+                    bounds.upperY <= nodeAABB.lowerBound[1] || bounds.lowerY >= nodeAABB.upperBound[1]) continue;
+            }
+
+            if (nodes[node].isLeaf())
+            {
+                visitor(nodes[node].particle, nodeAABB);
+            }
+            else
+            {
+                queryStack.push_back(nodes[node].left);
+                queryStack.push_back(nodes[node].right);
+            }
+        }
+    }
+
+    template <class T>
+    template <class Visitor>
+    void Tree<T>::query(const Bounds2i& bounds, Visitor&& visitor)
+    {
+        queryLeaves(bounds, [&bounds, &visitor](T particle, const AABB& aabb) {
+            int rightIntersectionX = static_cast<int>(aabb.lowerBound[0] - bounds.upperX);
+            int leftIntersectionX = static_cast<int>(aabb.upperBound[0] - bounds.lowerX);
+            int bottomIntersectionY = static_cast<int>(aabb.lowerBound[1] - bounds.upperY);
+            int topIntersectionY = static_cast<int>(aabb.upperBound[1] - bounds.lowerY);
+            visitor(AABBIntersection<T>{particle, leftIntersectionX, rightIntersectionX, topIntersectionY, bottomIntersectionY});
+        });
+    }
+
+    template <class T>
+    void Tree<T>::query(const Bounds2i& bounds, std::vector<AABBIntersection<T>>& intersections)
+    {
+        query(bounds, [&intersections](const AABBIntersection<T>& intersection) {
+            intersections.push_back(intersection);
+        });
+    }
+
     template <class T>
     const AABB& Tree<T>::getAABB(T particle)
     {
         return nodes[particleMap[particle]].aabb;
     }
 
+    template <class T>
+    std::optional<AABB> Tree<T>::findAABB(T particle)
+    {
+        auto it = particleMap.find(particle);
+        if (it == particleMap.end()) return std::nullopt;
+
+        return nodes[it->second].aabb;
+    }
+
     template <class T>
     void Tree<T>::insertLeaf(unsigned int leaf)
     {
@@ -1321,6 +1442,7 @@ namespace aabb
         nodes[newParent].parent = oldParent;
         nodes[newParent].aabb.merge(leafAABB, nodes[sibling].aabb);
         nodes[newParent].height = nodes[sibling].height + 1;
+        nodes[newParent].categories = nodes[leaf].categories | nodes[sibling].categories;
 
         // The sibling was not the root.
         if (oldParent != NULL_NODE)
@@ -1357,6 +1479,7 @@ namespace aabb
 
             nodes[index].height = 1 + std::max(nodes[left].height, nodes[right].height);
             nodes[index].aabb.merge(nodes[left].aabb, nodes[right].aabb);
+            nodes[index].categories = nodes[left].categories | nodes[right].categories;
 
             index = nodes[index].parent;
         }
@@ -1398,6 +1521,7 @@ namespace aabb
 
                 nodes[index].aabb.merge(nodes[left].aabb, nodes[right].aabb);
                 nodes[index].height = 1 + std::max(nodes[left].height, nodes[right].height);
+                nodes[index].categories = nodes[left].categories | nodes[right].categories;
 
                 index = nodes[index].parent;
             }
@@ -1460,6 +1584,8 @@ namespace aabb
                 nodes[rightRight].parent = node;
                 nodes[node].aabb.merge(nodes[left].aabb, nodes[rightRight].aabb);
                 nodes[right].aabb.merge(nodes[node].aabb, nodes[rightLeft].aabb);
+                nodes[node].categories = nodes[left].categories | nodes[rightRight].categories;
+                nodes[right].categories = nodes[node].categories | nodes[rightLeft].categories;
 
                 nodes[node].height = 1 + std::max(nodes[left].height, nodes[rightRight].height);
                 nodes[right].height = 1 + std::max(nodes[node].height, nodes[rightLeft].height);
@@ -1471,6 +1597,8 @@ namespace aabb
                 nodes[rightLeft].parent = node;
                 nodes[node].aabb.merge(nodes[left].aabb, nodes[rightLeft].aabb);
                 nodes[right].aabb.merge(nodes[node].aabb, nodes[rightRight].aabb);
+                nodes[node].categories = nodes[left].categories | nodes[rightLeft].categories;
+                nodes[right].categories = nodes[node].categories | nodes[rightRight].categories;
 
                 nodes[node].height = 1 + std::max(nodes[left].height, nodes[rightLeft].height);
                 nodes[right].height = 1 + std::max(nodes[node].height, nodes[rightRight].height);
@@ -1513,6 +1641,8 @@ namespace aabb
                 nodes[leftRight].parent = node;
                 nodes[node].aabb.merge(nodes[right].aabb, nodes[leftRight].aabb);
                 nodes[left].aabb.merge(nodes[node].aabb, nodes[leftLeft].aabb);
+                nodes[node].categories = nodes[right].categories | nodes[leftRight].categories;
+                nodes[left].categories = nodes[node].categories | nodes[leftLeft].categories;
 
                 nodes[node].height = 1 + std::max(nodes[right].height, nodes[leftRight].height);
                 nodes[left].height = 1 + std::max(nodes[node].height, nodes[leftLeft].height);
@@ -1524,6 +1654,8 @@ namespace aabb
                 nodes[leftLeft].parent = node;
                 nodes[node].aabb.merge(nodes[right].aabb, nodes[leftLeft].aabb);
                 nodes[left].aabb.merge(nodes[node].aabb, nodes[leftRight].aabb);
+                nodes[node].categories = nodes[right].categories | nodes[leftLeft].categories;
+                nodes[left].categories = nodes[node].categories | nodes[leftRight].categories;
 
                 nodes[node].height = 1 + std::max(nodes[right].height, nodes[leftLeft].height);
                 nodes[left].height = 1 + std::max(nodes[node].height, nodes[leftRight].height);
@@ -1678,6 +1810,7 @@ namespace aabb
             nodes[parent].right = index2;
             nodes[parent].height = 1 + std::max(nodes[index1].height, nodes[index2].height);
             nodes[parent].aabb.merge(nodes[index1].aabb, nodes[index2].aabb);
+            nodes[parent].categories = nodes[index1].categories | nodes[index2].categories;
             nodes[parent].parent = NULL_NODE;
 
             nodes[index1].parent = parent;
@@ -1749,20 +1882,21 @@ namespace aabb
         AABB aabb;
         aabb.merge(nodes[left].aabb, nodes[right].aabb);
 
-        for (unsigned int i=0;i<dimension;i++)
+        for (unsigned int i=0;i<DIMENSION;i++)
         {
             assert(aabb.lowerBound[i] == nodes[node].aabb.lowerBound[i]);
             assert(aabb.upperBound[i] == nodes[node].aabb.upperBound[i]);
         }
+        assert(nodes[node].categories == (nodes[left].categories | nodes[right].categories));
 
         validateMetrics(left);
         validateMetrics(right);
     }
 
     template <class T>
-    void Tree<T>::periodicBoundaries(std::vector<double>& position)
+    void Tree<T>::periodicBoundaries(Bound& position)
     {
-        for (unsigned int i=0;i<dimension;i++)
+        for (unsigned int i=0;i<DIMENSION;i++)
         {
             if (position[i] < 0)
             {
@@ -1779,11 +1913,11 @@ namespace aabb
     }
 
     template <class T>
-    bool Tree<T>::minimumImage(std::vector<double>& separation, std::vector<double>& shift)
+    bool Tree<T>::minimumImage(Bound& separation, Bound& shift)
     {
         bool isShifted = false;
 
-        for (unsigned int i=0;i<dimension;i++)
+        for (unsigned int i=0;i<DIMENSION;i++)
         {
             if (separation[i] < negMinImage[i])
             {